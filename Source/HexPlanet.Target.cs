@@ -20,6 +20,6 @@ public class HexPlanetTarget : TargetRules
 		ref List<string> OutExtraModuleNames
 		)
 	{
-		OutExtraModuleNames.AddRange( new string[] { "HexPlanet", "SimplexNoise" } );
+		OutExtraModuleNames.AddRange( new string[] { "HexPlanet", "HexPlanetCore", "SimplexNoise" } );
 	}
 }
@@ -7,7 +7,7 @@ public class HexPlanet : ModuleRules
 	public HexPlanet(TargetInfo Target)
 	{
         PublicIncludePaths.AddRange(new string[] { "ProceduralMeshComponent/Public", "ProceduralMeshComponent/Classes" });
-        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "RHI", "RenderCore", "ShaderCore", "ProceduralMeshComponent" });
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "RHI", "RenderCore", "ShaderCore", "ProceduralMeshComponent", "HexPlanetCore" });
 
         PrivateDependencyModuleNames.AddRange(new string[] { "SimplexNoise" });
 
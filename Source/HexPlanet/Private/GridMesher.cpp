@@ -51,18 +51,18 @@ int32 UGridMesher::buildNewMesh(const TArray<float>& vertexRadii, const TArray<F
 	debugLineOut->Flush();
 
 
-	for (const FRectGridLocation& gridLoc : myGrid->gridLocationsM)
+	for (int32 tileIndex = 0; tileIndex < myGrid->numNodes; ++tileIndex)
 	{
-		FVector tilePos = myGrid->getNodeLocationOnSphere(gridLoc);
-		Vertices.Add(tilePos * vertexRadii[gridLoc.tileIndex]);
+		FVector tilePos = myGrid->getTileLocationOnSphere(tileIndex);
+		Vertices.Add(tilePos * vertexRadii[tileIndex]);
 		if (calcNormals)
 		{
-			FVector vertexNormal = calculateVertexNormal(gridLoc, vertexRadii);
+			FVector vertexNormal = calculateVertexNormal(tileIndex, vertexRadii);
 			Normals.Add(vertexNormal);
 		}
 		else
 		{
-			Normals.Add(vertexNormals[gridLoc.tileIndex]);
+			Normals.Add(vertexNormals[tileIndex]);
 		}
 		if (renderNodes)
 		{
@@ -73,18 +73,18 @@ int32 UGridMesher::buildNewMesh(const TArray<float>& vertexRadii, const TArray<F
 			UTextRenderComponent* nodeTextId = NewObject<UTextRenderComponent>(this);
 			nodeTextId->RegisterComponent();
 			nodeTextId->SetRelativeLocation(tilePos * (baseMeshRadius*1.01));
-			nodeTextId->SetText(FText::FromString(FString::FromInt(gridLoc.tileIndex)));
+			nodeTextId->SetText(FText::FromString(FString::FromInt(tileIndex)));
 			nodeTextId->SetTextRenderColor(FColor::Red);
 			nodeTextId->SetWorldSize(baseMeshRadius / 50.0f);
 			FVector xAxis(1.0, 0.0, 0.0);
-			FRotator textRotator = Normals[gridLoc.tileIndex].Rotation() - xAxis.Rotation();
+			FRotator textRotator = Normals[tileIndex].Rotation() - xAxis.Rotation();
 			nodeTextId->AddRelativeRotation(textRotator);
 			nodeTextId->AttachTo(this);
 			debugTextOutArray.Add(nodeTextId);
 		}
 	}
 
-	for (int32 uLoc = 0; uLoc < myGrid->rectilinearGridM.Num(); ++uLoc)
+	for (int32 uLoc = 0; uLoc < myGrid->getNumRectilinearColumns(); ++uLoc)
 	{
 		for (int32 vLoc = 0; vLoc <= myGrid->gridFrequency * 2; ++vLoc)
 		{
@@ -93,23 +93,23 @@ int32 UGridMesher::buildNewMesh(const TArray<float>& vertexRadii, const TArray<F
 				//upperTriangle
 				int32 vertU = uLoc;
 				int32 vertV = vLoc;
-				Triangles.Add(myGrid->rectilinearGridM[vertU][vertV]);
+				Triangles.Add(myGrid->getRectilinearTile(vertU, vertV));
 				++vertV;
-				Triangles.Add(myGrid->rectilinearGridM[vertU][vertV]);
+				Triangles.Add(myGrid->getRectilinearTile(vertU, vertV));
 				--vertV;
 				myGrid->decrementU(vertU, vertV);
-				Triangles.Add(myGrid->rectilinearGridM[vertU][vertV]);
+				Triangles.Add(myGrid->getRectilinearTile(vertU, vertV));
 			}
 			if (vLoc != 0)
 			{
 				//lowerTriangle
 				int32 vertU = uLoc;
 				int32 vertV = vLoc;
-				Triangles.Add(myGrid->rectilinearGridM[vertU][vertV]);
+				Triangles.Add(myGrid->getRectilinearTile(vertU, vertV));
 				myGrid->decrementU(vertU, vertV);
-				Triangles.Add(myGrid->rectilinearGridM[vertU][vertV]);
+				Triangles.Add(myGrid->getRectilinearTile(vertU, vertV));
 				--vertV;
-				Triangles.Add(myGrid->rectilinearGridM[vertU][vertV]);
+				Triangles.Add(myGrid->getRectilinearTile(vertU, vertV));
 			}
 		}
 	}
@@ -147,10 +147,10 @@ void UGridMesher::rebuildBaseMeshFromGrid()
 	}
 }
 
-FVector UGridMesher::calculateVertexNormal(const FRectGridLocation& gridLoc, const TArray<float>& vertexRadii) const
+FVector UGridMesher::calculateVertexNormal(const int32& tileIndex, const TArray<float>& vertexRadii) const
 {
-	FVector tilePos = myGrid->getNodeLocationOnSphere(gridLoc) * vertexRadii[gridLoc.tileIndex];
-	TArray<int32> tileNeighbors = myGrid->getTileNeighborIndexes(gridLoc);
+	FVector tilePos = myGrid->getTileLocationOnSphere(tileIndex) * vertexRadii[tileIndex];
+	HexPlanet::FTileIndexView tileNeighbors = myGrid->getTileNeighborView(tileIndex);
 	FVector vertexNormal(0.0,0.0,0.0);
 	for (int32 neighborNum = 0; neighborNum < tileNeighbors.Num(); ++neighborNum)
 	{
@@ -159,8 +159,8 @@ FVector UGridMesher::calculateVertexNormal(const FRectGridLocation& gridLoc, con
 		{
 			neighbor2Num = 0;
 		}
-		vertexNormal += FVector::CrossProduct(myGrid->getNodeLocationOnSphere(myGrid->gridLocationsM[tileNeighbors[neighborNum]])*vertexRadii[tileNeighbors[neighborNum]],
-			myGrid->getNodeLocationOnSphere(myGrid->gridLocationsM[tileNeighbors[neighbor2Num]])*vertexRadii[tileNeighbors[neighbor2Num]]);
+		vertexNormal += FVector::CrossProduct(myGrid->getTileLocationOnSphere(tileNeighbors[neighborNum])*vertexRadii[tileNeighbors[neighborNum]],
+			myGrid->getTileLocationOnSphere(tileNeighbors[neighbor2Num])*vertexRadii[tileNeighbors[neighbor2Num]]);
 	}
 	vertexNormal /= tileNeighbors.Num();
 	vertexNormal /= FMath::Sqrt(FVector::DotProduct(vertexNormal, vertexNormal));
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HexPlanetMath.h"
+#include <vector>
+
+/*! Conversions between the engine types the components expose and the types of the core library*/
+
+FORCEINLINE HexPlanet::FVector3f toCoreVector(const FVector& engineVector)
+{
+	return HexPlanet::FVector3f(engineVector.X, engineVector.Y, engineVector.Z);
+}
+
+FORCEINLINE HexPlanet::FVector2f toCoreVector(const FVector2D& engineVector)
+{
+	return HexPlanet::FVector2f(engineVector.X, engineVector.Y);
+}
+
+FORCEINLINE FVector toEngineVector(const HexPlanet::FVector3f& coreVector)
+{
+	return FVector(coreVector.X, coreVector.Y, coreVector.Z);
+}
+
+FORCEINLINE FVector2D toEngineVector(const HexPlanet::FVector2f& coreVector)
+{
+	return FVector2D(coreVector.X, coreVector.Y);
+}
+
+template<typename ElementType>
+FORCEINLINE std::vector<ElementType> toCoreArray(const TArray<ElementType>& engineArray)
+{
+	return std::vector<ElementType>(engineArray.GetData(), engineArray.GetData() + engineArray.Num());
+}
+
+template<typename ElementType>
+FORCEINLINE TArray<ElementType> toEngineArray(const std::vector<ElementType>& coreArray)
+{
+	return TArray<ElementType>(coreArray.data(), int32(coreArray.size()));
+}
+
+/*! std::vector<bool> packs its bits, so it has no contiguous elements to copy*/
+FORCEINLINE TArray<bool> toEngineArray(const std::vector<bool>& coreArray)
+{
+	TArray<bool> engineArray;
+	engineArray.SetNumUninitialized(int32(coreArray.size()));
+	for (int32 elementIndex = 0; elementIndex < engineArray.Num(); ++elementIndex)
+	{
+		engineArray[elementIndex] = coreArray[elementIndex];
+	}
+	return engineArray;
+}
@@ -45,5 +45,5 @@ public:
 	USphereGrid* myGrid;
 
 	void rebuildBaseMeshFromGrid();
-	FVector calculateVertexNormal(const FRectGridLocation& gridLoc, const TArray<float>& vertexRadii) const;
+	FVector calculateVertexNormal(const int32& tileIndex, const TArray<float>& vertexRadii) const;
 };
@@ -3,6 +3,9 @@
 #pragma once
 
 #include "Components/ActorComponent.h"
+#include "IcosahedralGrid.h"
+#include "SphereGridPartition.h"
+#include "CoreConversions.h"
 #include "SphereGrid.generated.h"
 
 /*!
@@ -37,13 +40,29 @@ struct FRectGridLocation
 	TArray<FRectGridIndex> gridPositions;
 };
 
+/*!
+* \struct FGridTileRange
+* \brief A run of consecutive tile indexes
+*/
+USTRUCT(BlueprintType)
+struct FGridTileRange
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 firstTile;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 numTiles;
+};
+
 /*!
 * \class USphereGrid
 * \brief Actor Component For Building and Navigating the Grid
 * \details The Sphere Grid is responsible for building the grid
 * Delivering the tiles, and responsible for computing neighbors,
 * Manhattan distances between points, and translating between a 
-* spherical location and the corresponding tile.
+* spherical location and the corresponding tile. The work itself is
+* done by the HexPlanet::FIcosahedralGrid it wraps
 * \note the axial grid coordinate system for the produced grid
 * is such that u - v + w = 0
 */
@@ -64,26 +83,100 @@ public:
 	virtual void TickComponent( float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction ) override;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid Properties",
-		meta = (ClampMin = "1", UIMin = "1", ClampMax = "1000", UIMax = "1000"))
+		meta = (ClampMin = "1", UIMin = "1", ClampMax = "13107", UIMax = "1000"))
 		int32 gridFrequency;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid Properties")
 		int32 numNodes;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid Properties")
 		float icosahedronInteriorAngle;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Properties",
+		meta = (ToolTip = "Also keep a double precision copy of every tile's location on the unit sphere"))
+		bool cacheDoublePrecisionLocations;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Properties",
+		meta = (ToolTip = "Build the area, edge lengths and corners of every tile's spherical Voronoi cell"))
+		bool cacheDualCellGeometry;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Properties",
+		meta = (ToolTip = "Map positions to tiles in double precision, always on for frequencies above 1000"))
+		bool highResolutionMapping;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Properties",
+		meta = (ToolTip = "Cache the disk around every tile the first time a radius is asked for in getTileIndexesNStepsAway"))
+		bool cacheDiskStencils;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Properties",
+		meta = (ClampMin = "0", UIMin = "0", ToolTip = "Memory budget in megabytes for the cached disks, the least recently used radius is evicted first"))
+		int32 diskStencilCacheBudgetMB;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Properties",
+		meta = (ToolTip = "Number the tiles along a Morton curve inside each icosahedron diamond so neighboring tiles sit close together in memory"))
+		bool renumberTilesForLocality;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Properties",
+		meta = (ToolTip = "Map the grid topology read only from a cache file in the Saved directory, writing the file the first time a frequency is built"))
+		bool useTopologyCache;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Partition",
+		meta = (ClampMin = "1", UIMin = "1", UIMax = "16", ToolTip = "Every icosahedron diamond is cut into this many by this many chunks"))
+		int32 partitionChunksPerDiamondSide;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Grid Partition",
+		meta = (ClampMin = "0", UIMin = "0", UIMax = "8", ToolTip = "How many steps past its border the halo of a chunk reaches"))
+		int32 partitionHaloWidth;
 	
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
+	/*! The engine independent grid this component wraps, valid once the component has begun play*/
+	const HexPlanet::FIcosahedralGrid& getCoreGrid() const;
+	/*! The chunks the grid is split into along the icosahedron diamonds, valid once the component has begun play*/
+	const HexPlanet::FSphereGridPartition& getPartition() const;
+
+	UFUNCTION(BlueprintPure, Category = "Grid Partition")
+	int32 getNumChunks() const;
+	UFUNCTION(BlueprintPure, Category = "Grid Partition")
+	int32 getTileChunk(const int32& tileIndex) const;
+	/*! The tiles of a chunk in ascending order*/
+	UFUNCTION(BlueprintPure, Category = "Grid Partition")
+	TArray<int32> getChunkTiles(const int32& chunkIndex) const;
+	/*! The tiles of a chunk as runs of consecutive indexes*/
+	UFUNCTION(BlueprintPure, Category = "Grid Partition")
+	TArray<FGridTileRange> getChunkTileRanges(const int32& chunkIndex) const;
+	/*! The tiles of other chunks within partitionHaloWidth steps of the chunk*/
+	UFUNCTION(BlueprintPure, Category = "Grid Partition")
+	TArray<int32> getChunkHaloTiles(const int32& chunkIndex) const;
+	/*! The chunks sharing a border with the chunk*/
+	UFUNCTION(BlueprintPure, Category = "Grid Partition")
+	TArray<int32> getNeighborChunks(const int32& chunkIndex) const;
+
+	/*! Builds the full blueprint description of a tile from the packed grid positions*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	FRectGridLocation getGridLocation(const int32& tileIndex) const;
+	FRectGridIndex getPrimaryGridIndex(const int32& tileIndex) const;
+	/*! The number of positions a tile occupies on the grid, more than one only for seam tiles*/
+	int32 getNumGridPositions(const int32& tileIndex) const;
+	FRectGridIndex getGridIndex(const int32& tileIndex, const int32& positionNum) const;
+	static uint32 packGridIndex(const int32& uLoc, const int32& vLoc);
+	static FRectGridIndex unpackGridIndex(const uint32& packedIndex);
+
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	FRectGridLocation mapPosToTile(const FVector& positionOnSphere) const;
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	int32 mapPosToTileIndex(FVector positionOnSphere, ULineBatchComponent* debugOut = nullptr, float debugRadius = 200.0) const;
+	/*! Maps a whole batch of positions to tile indexes, several positions at a time where SIMD is available*/
+	void mapPositionsToTileIndexes(const FVector* positionsOnSphere, int32* outTileIndexes, int32 numPositions) const;
 
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	FVector getNodeLocationOnSphereUV(const int32& uLoc, const int32& vLoc) const;
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	FVector getNodeLocationOnSphere(const FRectGridLocation& gridTile) const;
+	/*! The cached location of a tile on the unit sphere*/
+	FVector getTileLocationOnSphere(const int32& tileIndex) const;
+	/*! The cached double precision location of a tile on the unit sphere, only valid if cacheDoublePrecisionLocations was set*/
+	void getTileLocationOnSphereDouble(const int32& tileIndex, double& outX, double& outY, double& outZ) const;
+	/*! The area of a tile's spherical Voronoi cell on the unit sphere, the mean tile area if cacheDualCellGeometry is off*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	float getTileCellArea(const int32& tileIndex) const;
+	/*! The unit sphere length of the cell edge a tile shares with its neighbor edgeNum, only valid if cacheDualCellGeometry was set*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	float getTileCellEdgeLength(const int32& tileIndex, const int32& edgeNum) const;
+	/*! Corner cornerNum of a tile's cell on the unit sphere, where the tile meets its neighbors cornerNum and cornerNum + 1*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	FVector getTileCellCorner(const int32& tileIndex, const int32& cornerNum) const;
 
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	TArray<FRectGridLocation> getLocationsForIndexes(const TArray<int32>& locationIndexs) const;
@@ -92,10 +185,13 @@ public:
 	TArray<FRectGridLocation> getTileNeighbors(const FRectGridLocation& gridTile) const;
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	TArray<int32> getTileNeighborIndexes(const FRectGridLocation& gridTile) const;
+	/*! The neighbors of a tile in ring order, read straight out of the neighbor table without allocating*/
+	HexPlanet::FTileIndexView getTileNeighborView(const int32& tileIndex) const;
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	TArray<FRectGridLocation> getTilesNStepsAway(const FRectGridLocation& gridTile, const int32& numSteps) const; 
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	TArray<int32> getTileIndexesNStepsAway(const FRectGridLocation& gridTile, const int32& numSteps) const;
+	TArray<int32> getTileIndexesNStepsAwayFromIndex(const int32& tileIndex, const int32& numSteps) const;
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	TArray<int32> getIndexNeighbors(const FRectGridIndex& gridIndex) const;
 
@@ -107,21 +203,107 @@ public:
 	TArray<FRectGridLocation> getStraightPathBetweenTiles(const FRectGridLocation& startTile, const FRectGridLocation& endTile) const;
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	TArray<int32> getStraightIndexPathBetweenTiles(const FRectGridLocation& startTile, const FRectGridLocation& endTile) const;
+	/*! Walks from tile to neighboring tile along the great circle arc between two tiles, both ends included*/
+	void traceGreatCircleBetweenTiles(const int32& startTile, const int32& endTile, TArray<int32>& outTileIndexes) const;
+	/*! Traces many arcs in parallel, the path of arc i is outPathTiles[outPathOffsets[i]] up to outPathTiles[outPathOffsets[i+1]]*/
+	void traceGreatCirclesBetweenTiles(const int32* startTiles, const int32* endTiles, int32 numPaths,
+		TArray<int32>& outPathOffsets, TArray<int32>& outPathTiles) const;
 	UFUNCTION(BlueprintPure, Category = "Grid Properties")
 	void expandTileSet(TArray<int32>& tileIndexSet, TArray<bool>& tileAvailability) const;
 
-	/*! The Raw Grid */
-	TArray<TArray<int32>> rectilinearGridM;
+	/*! The tile whose center is closest to a direction from the planet center*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	int32 findNearestTile(const FVector& direction) const;
+	/*! The tiles within arcAngle radians of a direction, searched outward from the nearest tile*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	TArray<int32> getTilesWithinAngle(const FVector& direction, const float& arcAngle) const;
+	/*! The numTiles tiles closest to a direction, nearest first*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	TArray<int32> getNearestTiles(const FVector& direction, const int32& numTiles) const;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid Properties")
-	TArray<FRectGridLocation> gridLocationsM;
+	/*! The number of steps on the shortest path between two tiles, computed from their grid positions without searching*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	int32 getGridDistance(const int32& tileA, const int32& tileB) const;
+	/*! The angle between two tiles on the unit sphere*/
+	UFUNCTION(BlueprintPure, Category = "Grid Properties")
+	float getGreatCircleDistance(const int32& tileA, const int32& tileB) const;
+	/*! Unit sphere great circle distances between tilesA[i] and tilesB[i], read from the cached tile locations*/
+	void getGreatCircleDistances(const int32* tilesA, const int32* tilesB, float* outDistances, int32 numPairs) const;
+	/*! Unit sphere great circle distances from one tile to each tile in a list*/
+	void getGreatCircleDistancesFromTile(const int32& originTile, const int32* tileIndexes, float* outDistances, int32 numTiles) const;
 
-	TMap<int32, FVector> gridReferencePointsM;
+	/*! The tile stored at (u, v) in the raw grid*/
+	int32 getRectilinearTile(const int32& uLoc, const int32& vLoc) const;
+	/*! The number of v positions in column u of the raw grid*/
+	int32 getRectilinearColumnLength(const int32& uLoc) const;
+	int32 getNumRectilinearColumns() const;
 
 protected:
+	static FRectGridIndex toRectGridIndex(const HexPlanet::FGridIndex& gridIndex);
 
-	void addTileToNeighborList(int32 nextU, int32 nextV, TArray<int32> &tilesInRange, int32& nextTileIndex) const;
-
-	TArray<FVector> createBaseIcosahedron();
-	FVector projectVectorOntoIcosahedronFace(const FVector& positionOnSphere, const FVector& refPoint, const FVector& uDir, const FVector& vDir) const;
+	HexPlanet::FIcosahedralGrid coreGridM;
+	HexPlanet::FSphereGridPartition partitionM;
 };
+
+FORCEINLINE const HexPlanet::FIcosahedralGrid& USphereGrid::getCoreGrid() const
+{
+	return coreGridM;
+}
+
+FORCEINLINE const HexPlanet::FSphereGridPartition& USphereGrid::getPartition() const
+{
+	return partitionM;
+}
+
+FORCEINLINE FRectGridIndex USphereGrid::toRectGridIndex(const HexPlanet::FGridIndex& gridIndex)
+{
+	FRectGridIndex rectGridIndex;
+	rectGridIndex.uPos = gridIndex.uPos;
+	rectGridIndex.vPos = gridIndex.vPos;
+	return rectGridIndex;
+}
+
+FORCEINLINE int32 USphereGrid::getRectilinearTile(const int32& uLoc, const int32& vLoc) const
+{
+	return coreGridM.getRectilinearTile(uLoc, vLoc);
+}
+
+FORCEINLINE int32 USphereGrid::getRectilinearColumnLength(const int32& uLoc) const
+{
+	return coreGridM.getRectilinearColumnLength(uLoc);
+}
+
+FORCEINLINE int32 USphereGrid::getNumRectilinearColumns() const
+{
+	return coreGridM.getNumRectilinearColumns();
+}
+
+FORCEINLINE uint32 USphereGrid::packGridIndex(const int32& uLoc, const int32& vLoc)
+{
+	return HexPlanet::FIcosahedralGrid::packGridIndex(uLoc, vLoc);
+}
+
+FORCEINLINE FRectGridIndex USphereGrid::unpackGridIndex(const uint32& packedIndex)
+{
+	return toRectGridIndex(HexPlanet::FIcosahedralGrid::unpackGridIndex(packedIndex));
+}
+
+FORCEINLINE FRectGridIndex USphereGrid::getPrimaryGridIndex(const int32& tileIndex) const
+{
+	return toRectGridIndex(coreGridM.getPrimaryGridIndex(tileIndex));
+}
+
+FORCEINLINE HexPlanet::FTileIndexView USphereGrid::getTileNeighborView(const int32& tileIndex) const
+{
+	return coreGridM.getTileNeighborView(tileIndex);
+}
+
+FORCEINLINE FVector USphereGrid::getTileLocationOnSphere(const int32& tileIndex) const
+{
+	return toEngineVector(coreGridM.getTileLocationOnSphere(tileIndex));
+}
+
+FORCEINLINE void USphereGrid::getTileLocationOnSphereDouble(const int32& tileIndex, double& outX, double& outY, double& outZ) const
+{
+	coreGridM.getTileLocationOnSphereDouble(tileIndex, outX, outY, outZ);
+}
@@ -5,6 +5,7 @@
 #include "Components/ActorComponent.h"
 #include "SphereGrid.h"
 #include "GridMesher.h"
+#include "TectonicSimulation.h"
 #include "TectonicPlateSimulator.generated.h"
 
 USTRUCT(BlueprintType)
@@ -13,7 +14,7 @@ struct FCrustCellData
 	GENERATED_USTRUCT_BODY()
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TectonicPlateSimulation")
-	FRectGridLocation gridLoc;
+	int32 tileIndex;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "TectonicPlateSimulation")
 	float cellHeight;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TectonicPlateSimulation")
@@ -55,6 +56,13 @@ struct FTectonicPlate
 	float plateBoundingRadius;
 };
 
+/*!
+* \class UTectonicPlateSimulator
+* \brief Actor Component exposing the plate simulation to blueprints and meshing its results
+* \details The simulation itself is run by the HexPlanet::FTectonicSimulation this component
+* wraps, the properties are handed to it before every call and the plates read back after. The crust
+* stays in the simulation's columns and is only copied out into FCrustCellData when asked for
+*/
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class HEXPLANET_API UTectonicPlateSimulator : public UActorComponent
 {
@@ -87,8 +95,16 @@ public:
 	void generateInitialHeightMap();
 	UFUNCTION(BlueprintPure, Category = "TectonicPlateSimulation")
 	FCrustCellData createBaseCrustCell(const int32& cellIndex, const float& cellHeight) const;
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TectonicPlateGeneration")
-		TArray<FCrustCellData> crustCells;		
+	/*! Copies the crust of every tile out of the simulation, cell i sits on tile i*/
+	UFUNCTION(BlueprintCallable, Category = "TectonicPlateGeneration")
+	TArray<FCrustCellData> exportCrustCells() const;
+	/*! Replaces the crust of the simulation*/
+	UFUNCTION(BlueprintCallable, Category = "TectonicPlateGeneration")
+	void importCrustCells(const TArray<FCrustCellData>& newCrustCells);
+	UFUNCTION(BlueprintPure, Category = "TectonicPlateGeneration")
+	FCrustCellData getCrustCell(const int32& tileIndex) const;
+	UFUNCTION(BlueprintPure, Category = "TectonicPlateGeneration")
+	int32 getNumCrustCells() const;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InitialHeightMap")
 		int32 heightMapSeed;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InitialHeightMap")
@@ -122,6 +138,9 @@ public:
 	void updatePlateCenterOfMass(FTectonicPlate &newPlate) const;
 	UFUNCTION(BlueprintCallable, Category = "TectonicPlateSimulation")
 	void updatePlateBoundingRadius(FTectonicPlate& newPlate) const;
+	/*! Whether the bounding caps of two of the current plates intersect*/
+	UFUNCTION(BlueprintPure, Category = "TectonicPlateSimulation")
+	bool mightPlatesOverlap(const int32& plateA, const int32& plateB) const;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TectonicPlateGeneration")
 		TArray<FTectonicPlate> currentPlates;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TectonicPlateGeneration")
@@ -162,6 +181,9 @@ public:
 	int32 plateDirectionSeed;
 	UFUNCTION(BlueprintCallable, Category = "TectonicPlateSimulation")
 	void erodeCell(FCrustCellData& targetCell);
+	/*! Erodes every crust cell in parallel from the heights at the start of the pass*/
+	UFUNCTION(BlueprintCallable, Category = "TectonicPlateSimulation")
+	void erodeCells();
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TectonicPlateSimulation",
 		meta = (ClampMin = "0.0", UIMin = "0.0", ClampMax = "100.0", UIMax = "100.0",
 			ToolTip = "The maximum amount of material that can be removed from a cell as a percentage of sea level"))
@@ -192,18 +214,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "TectonicPlateSimulation")
 	void transferCrustFromTargetCellToExistingCell(FCrustCellData &existingCrust,const FCrustCellData &targetCell, float percentCrustTransfer);
 	UFUNCTION(BlueprintCallable, Category = "TectonicPlateSimulation")
-	void applyForceToPlate(FTectonicPlate& targetPlate, const FRectGridLocation& forceLocation, const FVector2D& sphericalForce);
+	void applyForceToPlate(FTectonicPlate& targetPlate, const int32& forceLocationIndex, const FVector2D& sphericalForce);
 	UFUNCTION(BlueprintCallable, Category = "TectonicPlateSimulation")
 	void buildNewCrustFromPlateDivergence(const int32& locationIndex, TArray<FCrustCellData>& newCrustDataArray);
 	UFUNCTION(BlueprintCallable, Category = "TectonicPlateSimulation")
 	bool scatterMassOverArea(FTectonicPlate& targetPlate, const TArray<int32> potentialLocations, const FCrustCellData& collisionLocation, float transferRatio);
 
 protected:
-	void addNewSeedSetsToSetArray(TArray<bool> &usedTiles, TArray<TArray<int32>> &plateSets, const int32& numNewSets);
-	int32 getNextAvailableSeedTile(TArray<bool> &usedTiles, TArray<TArray<int32>> & plateSets);
-	void createVoronoiDiagramFromSeedSets(TArray<TArray<int32>>& seedSets, TArray<bool>& tileAvailability, const int32& maxNumIterations = -1);
-	void rebuildTectonicPlates(TArray<TArray<int32>>& plateSets, const float& percentTilesForReseed);
+	/*! Copies the properties and the planet into the core simulation*/
+	void pushSimulationSettings() const;
+	/*! Copies the properties and plates into the core simulation, only for the calls that work on every plate*/
+	void pushSimulationState() const;
+	/*! Copies where one plate is and how it moves into the core simulation, leaving its cell list behind*/
+	void pushPlateMotion(const int32& plateIndex) const;
+	/*! Copies the outputs of the core simulation's settings back into the properties*/
+	void pullSimulationSettings();
+	/*! Copies the plates and outputs of the core simulation back into the properties*/
+	void pullSimulationState();
+	void drawPlateCenterOfMass(const FTectonicPlate& plate) const;
 	void meshTectonicPlateOverlay();
+	/*! Owns the crust, everything else only mirrors the properties so const queries are free to refresh it*/
+	mutable HexPlanet::FTectonicSimulation coreSimulationM;
 	bool updateMesh;
 	
 
@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+public class HexPlanetCore : ModuleRules
+{
+	public HexPlanetCore(TargetInfo Target)
+	{
+		// the core is plain C++ shared with the standalone CMake build, so it doesn't use the engine's precompiled headers
+		PCHUsage = PCHUsageMode.NoPCHs;
+		// the standard library containers the core is built on expect exception handling to be enabled
+		bEnableExceptions = true;
+
+		PublicIncludePaths.AddRange(new string[] { "HexPlanetCore/Public" });
+		PrivateIncludePaths.AddRange(new string[] { "HexPlanetCore/Private" });
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CrustCellStore.h"
+
+namespace HexPlanet
+{
+	void FCrustCellStore::resize(int32 numCells)
+	{
+		const FCrustCell defaultCell;
+		tileIndexes.resize(numCells, defaultCell.tileIndex);
+		cellHeights.resize(numCells, defaultCell.cellHeight);
+		crustThicknesses.resize(numCells, defaultCell.crustThickness);
+		crustAreas.resize(numCells, defaultCell.crustArea);
+		crustDensities.resize(numCells, defaultCell.crustDensity);
+		owningPlates.resize(numCells, defaultCell.owningPlate);
+		cellTimeStamps.resize(numCells, defaultCell.cellTimeStamp);
+		cellVelocities.resize(numCells, defaultCell.cellVelocity);
+	}
+
+	void FCrustCellStore::swap(FCrustCellStore& other)
+	{
+		tileIndexes.swap(other.tileIndexes);
+		cellHeights.swap(other.cellHeights);
+		crustThicknesses.swap(other.crustThicknesses);
+		crustAreas.swap(other.crustAreas);
+		crustDensities.swap(other.crustDensities);
+		owningPlates.swap(other.owningPlates);
+		cellTimeStamps.swap(other.cellTimeStamps);
+		cellVelocities.swap(other.cellVelocities);
+	}
+
+	void FCrustCellStore::exportCells(std::vector<FCrustCell>& outCrustCells) const
+	{
+		outCrustCells.resize(num());
+		for (int32 cellIndex = 0; cellIndex < num(); ++cellIndex)
+		{
+			outCrustCells[cellIndex] = getCell(cellIndex);
+		}
+	}
+
+	void FCrustCellStore::importCells(const std::vector<FCrustCell>& crustCells)
+	{
+		resize(int32(crustCells.size()));
+		for (int32 cellIndex = 0; cellIndex < num(); ++cellIndex)
+		{
+			setCell(cellIndex, crustCells[cellIndex]);
+		}
+	}
+}
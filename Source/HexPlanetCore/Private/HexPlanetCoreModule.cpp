@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Core.h"
+#include "ModuleManager.h"
+#include "Async/ParallelFor.h"
+#include "HexPlanetParallel.h"
+
+namespace
+{
+	/*! Runs the core's parallel loops on the engine's task graph rather than on threads of their own*/
+	void engineParallelFor(HexPlanet::int32 num, const HexPlanet::FParallelForBody& body)
+	{
+		ParallelFor(num, [&body](int32 index)
+		{
+			body(index);
+		});
+	}
+}
+
+/*!
+* \class FHexPlanetCoreModule
+* \brief Loads the engine independent core into the engine
+* \details Only built by the engine, the CMake build of the core leaves this file out
+*/
+class FHexPlanetCoreModule : public IModuleInterface
+{
+public:
+	virtual void StartupModule() override
+	{
+		HexPlanet::setParallelForExecutor(&engineParallelFor);
+	}
+
+	virtual void ShutdownModule() override
+	{
+		HexPlanet::setParallelForExecutor(nullptr);
+	}
+};
+
+IMPLEMENT_MODULE(FHexPlanetCoreModule, HexPlanetCore);
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HexPlanetParallel.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace HexPlanet
+{
+	namespace
+	{
+		void runThreadedParallelFor(int32 num, const FParallelForBody& body)
+		{
+			const int32 numThreads = std::min<int32>(num, std::max<int32>(1, int32(std::thread::hardware_concurrency())));
+			if (numThreads <= 1)
+			{
+				for (int32 index = 0; index < num; ++index)
+				{
+					body(index);
+				}
+				return;
+			}
+			//every thread pulls the next index until they run out, so uneven bodies still balance out
+			std::atomic<int32> nextIndex(0);
+			auto runIndexes = [&]()
+			{
+				for (int32 index = nextIndex++; index < num; index = nextIndex++)
+				{
+					body(index);
+				}
+			};
+			std::vector<std::thread> workers;
+			workers.reserve(numThreads - 1);
+			for (int32 threadNum = 1; threadNum < numThreads; ++threadNum)
+			{
+				workers.emplace_back(runIndexes);
+			}
+			runIndexes();
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+		}
+
+		std::atomic<FParallelForExecutor>& getParallelForExecutor()
+		{
+			static std::atomic<FParallelForExecutor> parallelForExecutor(&runThreadedParallelFor);
+			return parallelForExecutor;
+		}
+	}
+
+	void setParallelForExecutor(FParallelForExecutor executor)
+	{
+		getParallelForExecutor() = executor != nullptr ? executor : &runThreadedParallelFor;
+	}
+
+	void parallelFor(int32 num, const FParallelForBody& body)
+	{
+		if (num <= 0)
+		{
+			return;
+		}
+		getParallelForExecutor().load()(num, body);
+	}
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HexPlanetCoreTypes.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define HEXPLANET_SIMD_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace HexPlanet
+{
+#if HEXPLANET_SIMD_SSE
+	/*!
+	* \struct FSSELanes
+	* \brief Four wide SSE lanes for the batched kernels
+	* \details The kernels are templates over the lanes so that every lane does the same
+	* float operations in the same order as the scalar path and gets the same answer
+	*/
+	struct FSSELanes
+	{
+		typedef __m128 Register;
+		static const int32 Width = 4;
+
+		static HEXPLANET_FORCEINLINE Register Load(const float* values) { return _mm_loadu_ps(values); }
+		static HEXPLANET_FORCEINLINE void Store(float* values, Register lanes) { _mm_storeu_ps(values, lanes); }
+		static HEXPLANET_FORCEINLINE Register Set(float value) { return _mm_set1_ps(value); }
+		static HEXPLANET_FORCEINLINE Register Add(Register a, Register b) { return _mm_add_ps(a, b); }
+		static HEXPLANET_FORCEINLINE Register Subtract(Register a, Register b) { return _mm_sub_ps(a, b); }
+		static HEXPLANET_FORCEINLINE Register Multiply(Register a, Register b) { return _mm_mul_ps(a, b); }
+		static HEXPLANET_FORCEINLINE Register Divide(Register a, Register b) { return _mm_div_ps(a, b); }
+		static HEXPLANET_FORCEINLINE Register Sqrt(Register a) { return _mm_sqrt_ps(a); }
+		static HEXPLANET_FORCEINLINE Register Greater(Register a, Register b) { return _mm_cmpgt_ps(a, b); }
+		static HEXPLANET_FORCEINLINE Register LessEqual(Register a, Register b) { return _mm_cmple_ps(a, b); }
+		static HEXPLANET_FORCEINLINE Register Select(Register mask, Register a, Register b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		//same x2 trick as roundToInt so that halves round the same way as the scalar path
+		static HEXPLANET_FORCEINLINE void RoundToInt(Register a, int32* values)
+		{
+			__m128i doubledRound = _mm_cvtps_epi32(_mm_add_ps(_mm_add_ps(a, a), _mm_set1_ps(0.5f)));
+			_mm_storeu_si128((__m128i*)values, _mm_srai_epi32(doubledRound, 1));
+		}
+	};
+#endif
+}
@@ -0,0 +1,1921 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "IcosahedralGrid.h"
+#include "SphereGridTopology.h"
+#include "SphereGridTopologyCache.h"
+#include "HexPlanetParallel.h"
+#include "HexPlanetSIMD.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+
+namespace HexPlanet
+{
+	FSphereGridSettings::FSphereGridSettings()
+		: gridFrequency(1), cacheDoublePrecisionLocations(false), cacheDualCellGeometry(true), highResolutionMapping(false), cacheDiskStencils(true), diskStencilCacheBudgetMB(128),
+		renumberTilesForLocality(false), useTopologyCache(false)
+	{
+	}
+
+	FIcosahedralGrid::FIcosahedralGrid()
+		: gridFrequency(1), numNodes(12), icosahedronInteriorAngle(0), diskStencilBytesM(0), diskStencilUseCounterM(0),
+		maxNeighborAngleM(0)
+	{
+	}
+
+	FIcosahedralGrid::~FIcosahedralGrid()
+	{
+	}
+
+	void FIcosahedralGrid::build(const FSphereGridSettings& settings)
+	{
+		settingsM = settings;
+		settingsM.highResolutionMapping = settings.highResolutionMapping || settings.gridFrequency > HighResolutionFrequency;
+		gridFrequency = settings.gridFrequency;
+		numNodes = 2 + 10 * gridFrequency*gridFrequency;
+		HEXPLANET_CHECK(gridFrequency >= 1 && gridFrequency <= MaxPackedGridFrequency);
+		//grids of the same frequency and numbering share one topology, only the first of them sets it up
+		topologyM = FSphereGridTopologyRegistry::findTopology(gridFrequency, getTopologyLayoutFlags());
+		if (!topologyM)
+		{
+			std::shared_ptr<FSphereGridTopology> newTopology = std::make_shared<FSphereGridTopology>(gridFrequency, getTopologyLayoutFlags());
+			//without a directory there's nowhere to put the cache, it would end up in whatever the working directory is
+			const bool useTopologyCache = settingsM.useTopologyCache && !settingsM.topologyCacheDirectory.empty();
+			if (!useTopologyCache || !newTopology->loadCache(settingsM.topologyCacheDirectory))
+			{
+				buildGridTopology();
+				shareGridTopology(*newTopology);
+				if (useTopologyCache)
+				{
+					newTopology->saveCache(settingsM.topologyCacheDirectory);
+				}
+			}
+			topologyM = FSphereGridTopologyRegistry::registerTopology(newTopology);
+		}
+		//shared and cached topologies never run buildGridTopology, so the angle is set here for every grid
+		const std::vector<FVector3f> baseIcosahedron = createBaseIcosahedron();
+		icosahedronInteriorAngle = acosClamped(FVector3f::dotProduct(baseIcosahedron[0], baseIcosahedron[1]));
+		viewGridTopology();
+		buildDoubleTileLocationTables();
+		buildDualCellTables();
+		buildFaceSelectionTables();
+		buildPentagonTable();
+		buildStripUnfoldingTable();
+		clearDiskStencilCache();
+	}
+
+	void FIcosahedralGrid::buildGridTopology()
+	{
+		//creating base icosahedron
+		std::vector<FVector3f> nodeLocations = createBaseIcosahedron();
+
+		tilePrimaryPositionsM.assign(std::vector<uint32>(numNodes));
+		gridReferencePointsM.clear();
+		//duplicate positions are collected in the order we find them and grouped by tile once the grid is done
+		std::vector<int32> seamTiles;
+		std::vector<uint32> seamTilePositions;
+		//lay out the columns back to back so the whole grid is a single allocation
+		std::vector<int32> columnOffsets(5 * gridFrequency + 1);
+		columnOffsets[0] = 0;
+		for (int32 uLoc = 0; uLoc < 5 * gridFrequency; ++uLoc)
+		{
+			int32 vSize = 2 * gridFrequency + 1 + (uLoc % gridFrequency == 0 ? gridFrequency : 0);
+			columnOffsets[uLoc + 1] = columnOffsets[uLoc] + vSize;
+		}
+		rectilinearGridM.assign(std::vector<int32>(columnOffsets[5 * gridFrequency], 0));
+		rectilinearColumnOffsetsM.assign(std::move(columnOffsets));
+		//order needs to be 1,8,4,2,6,9,3,11,7,5,10,0
+		const int32 referencePointOrder[12] = { 1, 8, 4, 2, 6, 9, 3, 11, 7, 5, 10, 0 };
+		int32 tileNum = 0;
+		for (int32 uLoc = 0; uLoc < getNumRectilinearColumns(); ++uLoc)
+		{
+			int32 vSize = getRectilinearColumnLength(uLoc);
+			for (int32 vLoc = 0; vLoc < vSize; vLoc++)
+			{
+				//establish the mapping of duplicate points
+				if (vLoc == 0 && uLoc != 0)
+				{
+					if (uLoc % gridFrequency == 0)
+					{
+						getRectilinearTileRef(uLoc, vLoc) = getRectilinearTile(0, 0);
+					}
+					else if (uLoc % gridFrequency != 0)
+					{
+						getRectilinearTileRef(uLoc, vLoc) = getRectilinearTile((uLoc / gridFrequency)*gridFrequency, gridFrequency-uLoc%gridFrequency);
+					}
+				}
+				else if (vLoc > 2*gridFrequency && uLoc != 0)
+				{
+					if (vLoc % gridFrequency == 0)
+					{
+						getRectilinearTileRef(uLoc, vLoc) = getRectilinearTile(0, vLoc);
+					}
+					else
+					{
+						getRectilinearTileRef(uLoc, vLoc) = getRectilinearTile(uLoc - vLoc%gridFrequency, vLoc - vLoc%gridFrequency);
+					}
+				}
+				else if(uLoc/gridFrequency == 4 && uLoc%gridFrequency!=0 && vLoc == vSize-1)
+				{
+					//handles wrap around
+					getRectilinearTileRef(uLoc, vLoc) = getRectilinearTile(0, vLoc + gridFrequency - uLoc%gridFrequency);
+				}
+				else
+				{
+					getRectilinearTileRef(uLoc, vLoc) = tileNum;
+					tilePrimaryPositionsM.getMutable(tileNum) = packGridIndex(uLoc, vLoc);
+					++tileNum;
+				}
+				const int32 gridTile = getRectilinearTile(uLoc, vLoc);
+				if (tilePrimaryPositionsM[gridTile] != packGridIndex(uLoc, vLoc))
+				{
+					seamTiles.push_back(gridTile);
+					seamTilePositions.push_back(packGridIndex(uLoc, vLoc));
+				}
+
+				//add this point as a reference point if it doesn't already exist
+				if (uLoc%gridFrequency==0 && vLoc%gridFrequency ==0)
+				{
+					if (gridReferencePointsM.count(getRectilinearTile(uLoc, vLoc)) == 0 && gridReferencePointsM.size() < 12)
+					{
+						gridReferencePointsM[getRectilinearTile(uLoc, vLoc)] = nodeLocations[referencePointOrder[gridReferencePointsM.size()]];
+					}
+				}
+			}
+		}
+
+		buildSeamPositionTable(seamTiles, seamTilePositions);
+		if (settingsM.renumberTilesForLocality)
+		{
+			std::vector<int32> newTileIndexes;
+			buildLocalityTileOrder(newTileIndexes);
+			renumberTiles(newTileIndexes);
+		}
+		buildTileNeighborTable();
+		buildTileLocationTables();
+		measureMaxNeighborAngle();
+	}
+
+	void FIcosahedralGrid::shareGridTopology(FSphereGridTopology& topology)
+	{
+		//hand the freshly built tables over without copying them
+		topology.rectilinearGrid = std::move(rectilinearGridM);
+		topology.rectilinearColumnOffsets = std::move(rectilinearColumnOffsetsM);
+		topology.tilePrimaryPositions = std::move(tilePrimaryPositionsM);
+		topology.seamTileSlots = std::move(seamTileSlotsM);
+		topology.seamPositionOffsets = std::move(seamPositionOffsetsM);
+		topology.seamPositions = std::move(seamPositionsM);
+		topology.gridReferencePoints = std::move(gridReferencePointsM);
+		topology.tileNeighborOffsets = std::move(tileNeighborOffsetsM);
+		topology.tileNeighbors = std::move(tileNeighborsM);
+		topology.tileLocationsX = std::move(tileLocationsXM);
+		topology.tileLocationsY = std::move(tileLocationsYM);
+		topology.tileLocationsZ = std::move(tileLocationsZM);
+		topology.maxNeighborAngle = maxNeighborAngleM;
+	}
+
+	void FIcosahedralGrid::viewGridTopology()
+	{
+		rectilinearGridM.view(topologyM->rectilinearGrid);
+		rectilinearColumnOffsetsM.view(topologyM->rectilinearColumnOffsets);
+		tilePrimaryPositionsM.view(topologyM->tilePrimaryPositions);
+		seamPositionOffsetsM.view(topologyM->seamPositionOffsets);
+		seamPositionsM.view(topologyM->seamPositions);
+		tileNeighborOffsetsM.view(topologyM->tileNeighborOffsets);
+		tileNeighborsM.view(topologyM->tileNeighbors);
+		tileLocationsXM.view(topologyM->tileLocationsX);
+		tileLocationsYM.view(topologyM->tileLocationsY);
+		tileLocationsZM.view(topologyM->tileLocationsZ);
+		//the lookups by tile stay per grid, they only hold the seam tiles and the twelve reference points
+		seamTileSlotsM = topologyM->seamTileSlots;
+		gridReferencePointsM = topologyM->gridReferencePoints;
+		maxNeighborAngleM = topologyM->maxNeighborAngle;
+	}
+
+	uint32 FIcosahedralGrid::getTopologyLayoutFlags() const
+	{
+		return settingsM.renumberTilesForLocality ? FSphereGridTopologyCache::RenumberedTilesFlag : 0;
+	}
+
+	void FIcosahedralGrid::buildSeamPositionTable(const std::vector<int32>& seamTiles, const std::vector<uint32>& seamTilePositions)
+	{
+		//give every seam tile a slot and count its positions
+		seamTileSlotsM.clear();
+		std::vector<int32> seamPositionCounts;
+		for (const int32& seamTile : seamTiles)
+		{
+			auto seamSlot = seamTileSlotsM.find(seamTile);
+			if (seamSlot == seamTileSlotsM.end())
+			{
+				seamTileSlotsM.emplace(seamTile, int32(seamPositionCounts.size()));
+				seamPositionCounts.push_back(1);
+			}
+			else
+			{
+				++seamPositionCounts[seamSlot->second];
+			}
+		}
+		std::vector<int32> seamOffsets(seamPositionCounts.size() + 1);
+		seamOffsets[0] = 0;
+		for (int32 seamSlot = 0; seamSlot < int32(seamPositionCounts.size()); ++seamSlot)
+		{
+			seamOffsets[seamSlot + 1] = seamOffsets[seamSlot] + seamPositionCounts[seamSlot];
+		}
+		//scatter the positions into their slots, keeping the order they were found in
+		std::vector<int32> nextSeamPosition = seamOffsets;
+		std::vector<uint32> seamPositions(seamTilePositions.size());
+		for (int32 seamPosition = 0; seamPosition < int32(seamTiles.size()); ++seamPosition)
+		{
+			seamPositions[nextSeamPosition[seamTileSlotsM[seamTiles[seamPosition]]]++] = seamTilePositions[seamPosition];
+		}
+		seamPositionOffsetsM.assign(std::move(seamOffsets));
+		seamPositionsM.assign(std::move(seamPositions));
+	}
+
+	namespace
+	{
+		//spreads the low 16 bits of value out to the even bits
+		HEXPLANET_FORCEINLINE uint32 spreadMortonBits(uint32 value)
+		{
+			value &= 0x0000ffff;
+			value = (value | (value << 8)) & 0x00ff00ff;
+			value = (value | (value << 4)) & 0x0f0f0f0f;
+			value = (value | (value << 2)) & 0x33333333;
+			value = (value | (value << 1)) & 0x55555555;
+			return value;
+		}
+	}
+
+	void FIcosahedralGrid::buildLocalityTileOrder(std::vector<int32>& outNewTileIndexes) const
+	{
+		//sort the tiles by diamond and then by the Morton code of their lattice steps inside it, the same
+		//diamonds FSphereGridPartition cuts chunks from, the two poles belong to no diamond and go last
+		std::vector<uint64> sortKeys(numNodes, std::numeric_limits<uint64>::max());
+		for (int32 diamondIndex = 0; diamondIndex < NumIcosahedronDiamonds; ++diamondIndex)
+		{
+			for (int32 uStep = 0; uStep < gridFrequency; ++uStep)
+			{
+				for (int32 vStep = 0; vStep < gridFrequency; ++vStep)
+				{
+					const uint32 mortonCode = spreadMortonBits(uStep) | (spreadMortonBits(vStep) << 1);
+					sortKeys[getDiamondTile(diamondIndex, uStep, vStep)] = (uint64(diamondIndex) << 60) | (uint64(mortonCode) << 32);
+				}
+			}
+		}
+		for (int32 tileIndex = 0; tileIndex < numNodes; ++tileIndex)
+		{
+			sortKeys[tileIndex] = (sortKeys[tileIndex] & ~uint64(0xFFFFFFFF)) | uint32(tileIndex);
+		}
+		std::sort(sortKeys.begin(), sortKeys.end());
+		outNewTileIndexes.resize(numNodes);
+		for (int32 newTileIndex = 0; newTileIndex < numNodes; ++newTileIndex)
+		{
+			outNewTileIndexes[uint32(sortKeys[newTileIndex])] = newTileIndex;
+		}
+	}
+
+	void FIcosahedralGrid::renumberTiles(const std::vector<int32>& newTileIndexes)
+	{
+		//only the tables that exist before the neighbor table is built need rewriting,
+		//everything built after that is built in the new order
+		for (int32 gridSlot = 0; gridSlot < rectilinearGridM.Num(); ++gridSlot)
+		{
+			int32& gridTile = rectilinearGridM.getMutable(gridSlot);
+			gridTile = newTileIndexes[gridTile];
+		}
+		const std::vector<uint32> oldPrimaryPositions(tilePrimaryPositionsM.begin(), tilePrimaryPositionsM.end());
+		for (int32 tileIndex = 0; tileIndex < numNodes; ++tileIndex)
+		{
+			tilePrimaryPositionsM.getMutable(newTileIndexes[tileIndex]) = oldPrimaryPositions[tileIndex];
+		}
+		const std::unordered_map<int32, int32> oldSeamTileSlots = seamTileSlotsM;
+		seamTileSlotsM.clear();
+		for (const auto& seamTileSlot : oldSeamTileSlots)
+		{
+			seamTileSlotsM.emplace(newTileIndexes[seamTileSlot.first], seamTileSlot.second);
+		}
+		const std::map<int32, FVector3f> oldReferencePoints = gridReferencePointsM;
+		gridReferencePointsM.clear();
+		for (const auto& referencePoint : oldReferencePoints)
+		{
+			gridReferencePointsM.emplace(newTileIndexes[referencePoint.first], referencePoint.second);
+		}
+	}
+
+	void FIcosahedralGrid::buildTileNeighborTable()
+	{
+		//flatten every tile's ring of neighbors into a single table so that neighbor
+		//queries become a walk over contiguous memory instead of a merge of duplicate positions
+		std::vector<int64> neighborOffsets(numNodes + 1);
+		std::vector<int32> neighbors;
+		neighbors.reserve(size_t(numNodes) * 6);
+		for (int32 tileIndex = 0; tileIndex < numNodes; ++tileIndex)
+		{
+			neighborOffsets[tileIndex] = int64(neighbors.size());
+			const std::vector<int32> tileNeighbors = mergeTileNeighborIndexes(tileIndex);
+			neighbors.insert(neighbors.end(), tileNeighbors.begin(), tileNeighbors.end());
+		}
+		neighborOffsets[numNodes] = int64(neighbors.size());
+		neighbors.shrink_to_fit();
+		tileNeighborOffsetsM.assign(std::move(neighborOffsets));
+		tileNeighborsM.assign(std::move(neighbors));
+	}
+
+	std::vector<FVector3f> FIcosahedralGrid::createBaseIcosahedron() const
+	{
+		float x = 1;
+		float z = (1 + std::sqrt(5.0f)) / 2.0;
+		float baseHedronRadius = std::sqrt(x*x + z*z);
+		float pointMagnitudeRatio = 1.0 / baseHedronRadius;
+		x *= pointMagnitudeRatio;
+		z *= pointMagnitudeRatio;
+
+		std::vector<FVector3f> nodeLocations(12, FVector3f(0, 0, 0));
+
+		nodeLocations[0] = FVector3f(0, x, z);
+		nodeLocations[1] = FVector3f(0, x, -z);
+		nodeLocations[2] = FVector3f(0, -x, z);
+		nodeLocations[3] = FVector3f(0, -x, -z);
+		nodeLocations[4] = FVector3f(z, 0, x);
+		nodeLocations[5] = FVector3f(-z, 0, x);
+		nodeLocations[6] = FVector3f(z, 0, -x);
+		nodeLocations[7] = FVector3f(-z, 0, -x);
+		nodeLocations[8] = FVector3f(x, z, 0);
+		nodeLocations[9] = FVector3f(x, -z, 0);
+		nodeLocations[10] = FVector3f(-x, z, 0);
+		nodeLocations[11] = FVector3f(-x, -z, 0);
+
+		return nodeLocations;
+	}
+
+#if HEXPLANET_SIMD_SSE
+	/*!
+	* Maps one block of Lanes::Width positions to tile indexes, it follows mapPosToTileIndex
+	* step for step so that every lane produces the same answer as the scalar path
+	*/
+	template<typename Lanes>
+	static void mapPositionBlockToTileIndexes(const FIcosahedralGrid& grid, const FVector3f* positionsOnSphere, int32* outTileIndexes)
+	{
+		typedef typename Lanes::Register Register;
+		const int32 Width = Lanes::Width;
+		float laneValues[3][Width];
+		for (int32 lane = 0; lane < Width; ++lane)
+		{
+			laneValues[0][lane] = positionsOnSphere[lane].X;
+			laneValues[1][lane] = positionsOnSphere[lane].Y;
+			laneValues[2][lane] = positionsOnSphere[lane].Z;
+		}
+		Register posX = Lanes::Load(laneValues[0]);
+		Register posY = Lanes::Load(laneValues[1]);
+		Register posZ = Lanes::Load(laneValues[2]);
+
+		//normalize the positions
+		Register invLength = Lanes::Divide(Lanes::Set(1.0f),
+			Lanes::Sqrt(Lanes::Add(Lanes::Add(Lanes::Multiply(posX, posX), Lanes::Multiply(posY, posY)), Lanes::Multiply(posZ, posZ))));
+		posX = Lanes::Multiply(posX, invLength);
+		posY = Lanes::Multiply(posY, invLength);
+		posZ = Lanes::Multiply(posZ, invLength);
+
+		//keep a running top three of the selection points in every lane
+		Register closestDots[3];
+		Register closestPoints[3];
+		for (int32 rank = 0; rank < 3; ++rank)
+		{
+			closestDots[rank] = Lanes::Set(-std::numeric_limits<float>::max());
+			closestPoints[rank] = Lanes::Set(0.0f);
+		}
+		for (int32 selectionPoint = 0; selectionPoint < FIcosahedralGrid::NumFaceSelectionPoints; ++selectionPoint)
+		{
+			const FVector3f& refPoint = grid.faceSelectionPointsM[selectionPoint];
+			Register pointDot = Lanes::Add(Lanes::Add(Lanes::Multiply(posX, Lanes::Set(refPoint.X)), Lanes::Multiply(posY, Lanes::Set(refPoint.Y))),
+				Lanes::Multiply(posZ, Lanes::Set(refPoint.Z)));
+			Register pointIndex = Lanes::Set(float(selectionPoint));
+			Register beats0 = Lanes::Greater(pointDot, closestDots[0]);
+			Register beats1 = Lanes::Greater(pointDot, closestDots[1]);
+			Register beats2 = Lanes::Greater(pointDot, closestDots[2]);
+			closestDots[2] = Lanes::Select(beats1, closestDots[1], Lanes::Select(beats2, pointDot, closestDots[2]));
+			closestPoints[2] = Lanes::Select(beats1, closestPoints[1], Lanes::Select(beats2, pointIndex, closestPoints[2]));
+			closestDots[1] = Lanes::Select(beats0, closestDots[0], Lanes::Select(beats1, pointDot, closestDots[1]));
+			closestPoints[1] = Lanes::Select(beats0, closestPoints[0], Lanes::Select(beats1, pointIndex, closestPoints[1]));
+			closestDots[0] = Lanes::Select(beats0, pointDot, closestDots[0]);
+			closestPoints[0] = Lanes::Select(beats0, pointIndex, closestPoints[0]);
+		}
+		float closestPointValues[3][Width];
+		for (int32 rank = 0; rank < 3; ++rank)
+		{
+			Lanes::Store(closestPointValues[rank], closestPoints[rank]);
+		}
+
+		//gather the diamond of every lane
+		const FIcosahedronDiamond* laneDiamonds[Width];
+		for (int32 lane = 0; lane < Width; ++lane)
+		{
+			const int32 selectionKey = (int32(closestPointValues[0][lane]) * FIcosahedralGrid::NumFaceSelectionPoints
+				+ int32(closestPointValues[1][lane])) * FIcosahedralGrid::NumFaceSelectionPoints + int32(closestPointValues[2][lane]);
+			laneDiamonds[lane] = &grid.diamondsM[grid.faceSelectionTableM[selectionKey]];
+		}
+
+		//pick the triangle, comparing the two dot products exactly as the scalar path does
+		float upperValues[2][3][Width];
+		for (int32 lane = 0; lane < Width; ++lane)
+		{
+			for (int32 axis = 0; axis < 3; ++axis)
+			{
+				upperValues[0][axis][lane] = laneDiamonds[lane]->ref12[axis];
+				upperValues[1][axis][lane] = laneDiamonds[lane]->ref21[axis];
+			}
+		}
+		Register ref12Dot = Lanes::Add(Lanes::Add(Lanes::Multiply(posX, Lanes::Load(upperValues[0][0])), Lanes::Multiply(posY, Lanes::Load(upperValues[0][1]))),
+			Lanes::Multiply(posZ, Lanes::Load(upperValues[0][2])));
+		Register ref21Dot = Lanes::Add(Lanes::Add(Lanes::Multiply(posX, Lanes::Load(upperValues[1][0])), Lanes::Multiply(posY, Lanes::Load(upperValues[1][1]))),
+			Lanes::Multiply(posZ, Lanes::Load(upperValues[1][2])));
+		float upperTriangle[Width];
+		Lanes::Store(upperTriangle, Lanes::Greater(ref12Dot, ref21Dot));
+
+		//gather the face basis of every lane
+		enum EBasisValue { RefX, RefY, RefZ, UDirX, UDirY, UDirZ, VDirX, VDirY, VDirZ, NormalX, NormalY, NormalZ, PlaneR, UMag, VMag, UDotV, Divisor, NumBasisValues };
+		float basisValues[NumBasisValues][Width];
+		for (int32 lane = 0; lane < Width; ++lane)
+		{
+			const FIcosahedronFaceBasis& faceBasis = laneDiamonds[lane]->faces[upperTriangle[lane] != 0.0f ? 1 : 0];
+			basisValues[RefX][lane] = faceBasis.refPoint.X;
+			basisValues[RefY][lane] = faceBasis.refPoint.Y;
+			basisValues[RefZ][lane] = faceBasis.refPoint.Z;
+			basisValues[UDirX][lane] = faceBasis.uDir.X;
+			basisValues[UDirY][lane] = faceBasis.uDir.Y;
+			basisValues[UDirZ][lane] = faceBasis.uDir.Z;
+			basisValues[VDirX][lane] = faceBasis.vDir.X;
+			basisValues[VDirY][lane] = faceBasis.vDir.Y;
+			basisValues[VDirZ][lane] = faceBasis.vDir.Z;
+			basisValues[NormalX][lane] = faceBasis.planeNormal.X;
+			basisValues[NormalY][lane] = faceBasis.planeNormal.Y;
+			basisValues[NormalZ][lane] = faceBasis.planeNormal.Z;
+			basisValues[PlaneR][lane] = faceBasis.planeR;
+			basisValues[UMag][lane] = faceBasis.uMag;
+			basisValues[VMag][lane] = faceBasis.vMag;
+			basisValues[UDotV][lane] = faceBasis.uDotV;
+			basisValues[Divisor][lane] = faceBasis.divisor;
+		}
+
+		//project onto the face
+		Register planeR = Lanes::Load(basisValues[PlaneR]);
+		Register invNormalDot = Lanes::Divide(Lanes::Set(1.0f), Lanes::Add(Lanes::Add(
+			Lanes::Multiply(Lanes::Load(basisValues[NormalX]), posX), Lanes::Multiply(Lanes::Load(basisValues[NormalY]), posY)),
+			Lanes::Multiply(Lanes::Load(basisValues[NormalZ]), posZ)));
+		Register localX = Lanes::Subtract(Lanes::Multiply(Lanes::Multiply(posX, planeR), invNormalDot), Lanes::Load(basisValues[RefX]));
+		Register localY = Lanes::Subtract(Lanes::Multiply(Lanes::Multiply(posY, planeR), invNormalDot), Lanes::Load(basisValues[RefY]));
+		Register localZ = Lanes::Subtract(Lanes::Multiply(Lanes::Multiply(posZ, planeR), invNormalDot), Lanes::Load(basisValues[RefZ]));
+
+		//Cramer's rule for system of equations for project onto non orthogonal basis
+		Register lVDotU = Lanes::Add(Lanes::Add(Lanes::Multiply(localX, Lanes::Load(basisValues[UDirX])), Lanes::Multiply(localY, Lanes::Load(basisValues[UDirY]))),
+			Lanes::Multiply(localZ, Lanes::Load(basisValues[UDirZ])));
+		Register lVDotV = Lanes::Add(Lanes::Add(Lanes::Multiply(localX, Lanes::Load(basisValues[VDirX])), Lanes::Multiply(localY, Lanes::Load(basisValues[VDirY]))),
+			Lanes::Multiply(localZ, Lanes::Load(basisValues[VDirZ])));
+		Register uDotV = Lanes::Load(basisValues[UDotV]);
+		Register divisor = Lanes::Load(basisValues[Divisor]);
+		Register uIncAprox = Lanes::Divide(Lanes::Subtract(lVDotU, Lanes::Multiply(uDotV, lVDotV)), divisor);
+		Register vIncAprox = Lanes::Divide(Lanes::Subtract(lVDotV, Lanes::Multiply(uDotV, lVDotU)), divisor);
+		int32 uIncs[Width];
+		int32 vIncs[Width];
+		Lanes::RoundToInt(Lanes::Divide(uIncAprox, Lanes::Load(basisValues[UMag])), uIncs);
+		Lanes::RoundToInt(Lanes::Divide(vIncAprox, Lanes::Load(basisValues[VMag])), vIncs);
+
+		for (int32 lane = 0; lane < Width; ++lane)
+		{
+			int32 vInc = vIncs[lane];
+			//adjust for the offset of the u1 location
+			if (uIncs[lane] > 0)
+			{
+				vInc -= grid.gridFrequency;
+			}
+			int32 uRef1 = laneDiamonds[lane]->uRef1 + uIncs[lane];
+			if (uRef1 >= 5 * grid.gridFrequency)
+			{
+				uRef1 -= 5 * grid.gridFrequency;
+			}
+			outTileIndexes[lane] = grid.getRectilinearTile(uRef1, laneDiamonds[lane]->vRef11 + vInc);
+		}
+	}
+#endif
+
+	namespace
+	{
+		/*! The parts of a diamond the mapping reads, in the precision a position is mapped with*/
+		template<typename T>
+		struct TDiamondPrecision;
+
+		template<>
+		struct TDiamondPrecision<float>
+		{
+			static const FVector3f& getRef12(const FIcosahedronDiamond& diamond) { return diamond.ref12; }
+			static const FVector3f& getRef21(const FIcosahedronDiamond& diamond) { return diamond.ref21; }
+			static const FIcosahedronFaceBasis& getFace(const FIcosahedronDiamond& diamond, bool upperTriangle) { return diamond.faces[upperTriangle ? 1 : 0]; }
+		};
+
+		template<>
+		struct TDiamondPrecision<double>
+		{
+			static const FVector3d& getRef12(const FIcosahedronDiamond& diamond) { return diamond.ref12Double; }
+			static const FVector3d& getRef21(const FIcosahedronDiamond& diamond) { return diamond.ref21Double; }
+			static const TIcosahedronFaceBasis<double>& getFace(const FIcosahedronDiamond& diamond, bool upperTriangle) { return diamond.facesDouble[upperTriangle ? 1 : 0]; }
+		};
+
+		FVector3d toDoubleVector(const FVector3f& floatVector)
+		{
+			return FVector3d(floatVector.X, floatVector.Y, floatVector.Z);
+		}
+	}
+
+	const FIcosahedronDiamond& FIcosahedralGrid::selectFaceDiamond(const FVector3f& unitPositionOnSphere, bool& outUpperTriangle) const
+	{
+		return findFaceDiamond(faceSelectionPointsM, unitPositionOnSphere, outUpperTriangle);
+	}
+
+	const FIcosahedronDiamond& FIcosahedralGrid::selectFaceDiamond(const FVector3d& unitPositionOnSphere, bool& outUpperTriangle) const
+	{
+		return findFaceDiamond(faceSelectionPointsDoubleM, unitPositionOnSphere, outUpperTriangle);
+	}
+
+	template<typename T>
+	const FIcosahedronDiamond& FIcosahedralGrid::findFaceDiamond(const TVector3<T>* selectionPoints, const TVector3<T>& unitPositionOnSphere,
+		bool& outUpperTriangle) const
+	{
+		//find the three closest reference points that aren't the duplicated points, this establishes the icsoahedron face we're on
+		int32 closestPoints[3] = { 0, 0, 0 };
+		T closestDots[3] = { -std::numeric_limits<T>::max(), -std::numeric_limits<T>::max(), -std::numeric_limits<T>::max() };
+		for (int32 selectionPoint = 0; selectionPoint < NumFaceSelectionPoints; ++selectionPoint)
+		{
+			T pointDot = TVector3<T>::dotProduct(unitPositionOnSphere, selectionPoints[selectionPoint]);
+			if (pointDot > closestDots[2])
+			{
+				int32 insertAt = 2;
+				for (; insertAt > 0 && pointDot > closestDots[insertAt - 1]; --insertAt)
+				{
+					closestDots[insertAt] = closestDots[insertAt - 1];
+					closestPoints[insertAt] = closestPoints[insertAt - 1];
+				}
+				closestDots[insertAt] = pointDot;
+				closestPoints[insertAt] = selectionPoint;
+			}
+		}
+		const FIcosahedronDiamond& refDiamond = diamondsM[faceSelectionTableM[
+			(closestPoints[0] * NumFaceSelectionPoints + closestPoints[1]) * NumFaceSelectionPoints + closestPoints[2]]];
+		//if we're closer to u1v12 than u2v21 we're in the upper triangle, otherwise we're in the lower triangle
+		outUpperTriangle = TVector3<T>::dotProduct(unitPositionOnSphere, TDiamondPrecision<T>::getRef12(refDiamond))
+			> TVector3<T>::dotProduct(unitPositionOnSphere, TDiamondPrecision<T>::getRef21(refDiamond));
+		return refDiamond;
+	}
+
+	int32 FIcosahedralGrid::mapPosToTileIndex(FVector3f positionOnSphere) const
+	{
+		if (settingsM.highResolutionMapping)
+		{
+			return mapPosToTileIndexDouble(toDoubleVector(positionOnSphere));
+		}
+		//start by normalizing the position
+		positionOnSphere /= std::sqrt(FVector3f::dotProduct(positionOnSphere, positionOnSphere));
+		return mapUnitPosToTileIndex(positionOnSphere);
+	}
+
+	int32 FIcosahedralGrid::mapPosToTileIndexDouble(FVector3d positionOnSphere) const
+	{
+		positionOnSphere /= std::sqrt(FVector3d::dotProduct(positionOnSphere, positionOnSphere));
+		return mapUnitPosToTileIndex(positionOnSphere);
+	}
+
+	template<typename T>
+	int32 FIcosahedralGrid::mapUnitPosToTileIndex(const TVector3<T>& positionOnSphere) const
+	{
+		bool upperTriangle;
+		const FIcosahedronDiamond& refDiamond = selectFaceDiamond(positionOnSphere, upperTriangle);
+		const TIcosahedronFaceBasis<T>& faceBasis = TDiamondPrecision<T>::getFace(refDiamond, upperTriangle);
+
+		//the local Vector
+		TVector3<T> projectedVector = faceBasis.planeR*positionOnSphere / TVector3<T>::dotProduct(faceBasis.planeNormal, positionOnSphere);
+		TVector3<T> localVector = projectedVector - faceBasis.refPoint;
+
+		//Cramer's rule for system of equations for project onto non orthogonal basis
+		T lVDotU = TVector3<T>::dotProduct(localVector, faceBasis.uDir);
+		T lVDotV = TVector3<T>::dotProduct(localVector, faceBasis.vDir);
+
+		//determine u
+		T uIncAprox = (lVDotU - faceBasis.uDotV*lVDotV) / faceBasis.divisor;
+		int32 uInc = roundToInt(uIncAprox / faceBasis.uMag);
+		//determine v
+		T vIncAprox = (lVDotV - faceBasis.uDotV*lVDotU) / faceBasis.divisor;
+		int32 vInc = roundToInt(vIncAprox / faceBasis.vMag);
+		//adjust for the offset of the u1 location
+		if (uInc > 0)
+		{
+			vInc -= gridFrequency;
+		}
+		int32 uRef1 = refDiamond.uRef1 + uInc;
+		if (uRef1 >= 5* gridFrequency)
+		{
+			uRef1 -= 5 * gridFrequency;
+		}
+		return getRectilinearTile(uRef1, refDiamond.vRef11 + vInc);
+	}
+
+	void FIcosahedralGrid::mapPositionsToTileIndexes(const FVector3f* positionsOnSphere, int32* outTileIndexes, int32 numPositions) const
+	{
+		int32 positionIndex = 0;
+#if HEXPLANET_SIMD_SSE
+		//the SIMD lanes are single precision, high resolution grids map every position through the scalar path
+		for (; !settingsM.highResolutionMapping && positionIndex + FSSELanes::Width <= numPositions; positionIndex += FSSELanes::Width)
+		{
+			mapPositionBlockToTileIndexes<FSSELanes>(*this, positionsOnSphere + positionIndex, outTileIndexes + positionIndex);
+		}
+#endif
+		//whatever doesn't fill a whole block goes through the scalar path
+		for (; positionIndex < numPositions; ++positionIndex)
+		{
+			outTileIndexes[positionIndex] = mapPosToTileIndex(positionsOnSphere[positionIndex]);
+		}
+	}
+
+	void FIcosahedralGrid::buildFaceSelectionTables()
+	{
+		//the reference points that can take part in selecting a face, the duplicated polar points never do
+		std::vector<int32> refenceIndexes;
+		for (const auto& referencePoint : gridReferencePointsM)
+		{
+			if (referencePoint.first != getRectilinearTile(0, 0) && referencePoint.first != getRectilinearTile(0, gridFrequency * 3))
+			{
+				refenceIndexes.push_back(referencePoint.first);
+			}
+		}
+		HEXPLANET_CHECK(refenceIndexes.size() == NumFaceSelectionPoints);
+		FGridIndex selectionPositions[NumFaceSelectionPoints];
+		for (int32 selectionPoint = 0; selectionPoint < NumFaceSelectionPoints; ++selectionPoint)
+		{
+			faceSelectionPointsM[selectionPoint] = gridReferencePointsM.at(refenceIndexes[selectionPoint]);
+			faceSelectionPointsDoubleM[selectionPoint] = toDoubleVector(faceSelectionPointsM[selectionPoint]);
+			selectionPositions[selectionPoint] = getPrimaryGridIndex(refenceIndexes[selectionPoint]);
+		}
+
+		//every face lies in one of the ten diamonds spanned by two neighboring u reference lines
+		for (int32 diamondIndex = 0; diamondIndex < NumIcosahedronDiamonds; ++diamondIndex)
+		{
+			FIcosahedronDiamond& diamond = diamondsM[diamondIndex];
+			diamond.uRef1 = (diamondIndex / 2)*gridFrequency;
+			diamond.vRef11 = (diamondIndex % 2 + 1)*gridFrequency;
+			const int32 uRef2 = (diamond.uRef1 + gridFrequency) % (5 * gridFrequency);
+			const int32 vRef12 = diamond.vRef11 + gridFrequency;
+			const int32 vRef21 = diamond.vRef11 - gridFrequency;
+			const int32 vRef22 = diamond.vRef11;
+			diamond.ref11 = gridReferencePointsM.at(getRectilinearTile(diamond.uRef1, diamond.vRef11));
+			diamond.ref12 = gridReferencePointsM.at(getRectilinearTile(diamond.uRef1, vRef12));
+			diamond.ref21 = gridReferencePointsM.at(getRectilinearTile(uRef2, vRef21));
+			diamond.ref22 = gridReferencePointsM.at(getRectilinearTile(uRef2, vRef22));
+			buildFaceBasis(diamond.ref11, diamond.ref21 - diamond.ref11, diamond.ref22 - diamond.ref21, diamond.faces[0]);
+			buildFaceBasis(diamond.ref11, diamond.ref22 - diamond.ref12, diamond.ref12 - diamond.ref11, diamond.faces[1]);
+			//the double precision faces start from the same single precision corners the tile locations are interpolated from
+			const FVector3d ref11Double = toDoubleVector(diamond.ref11);
+			const FVector3d ref22Double = toDoubleVector(diamond.ref22);
+			diamond.ref12Double = toDoubleVector(diamond.ref12);
+			diamond.ref21Double = toDoubleVector(diamond.ref21);
+			buildFaceBasis(ref11Double, diamond.ref21Double - ref11Double, ref22Double - diamond.ref21Double, diamond.facesDouble[0]);
+			buildFaceBasis(ref11Double, ref22Double - diamond.ref12Double, diamond.ref12Double - ref11Double, diamond.facesDouble[1]);
+		}
+
+		//resolve every ordering of the three closest selection points to the diamond it describes
+		for (int32 closest0 = 0; closest0 < NumFaceSelectionPoints; ++closest0)
+		{
+			for (int32 closest1 = 0; closest1 < NumFaceSelectionPoints; ++closest1)
+			{
+				for (int32 closest2 = 0; closest2 < NumFaceSelectionPoints; ++closest2)
+				{
+					int32 uRef1, vRef11;
+					FGridIndex refPoints[3];
+					refPoints[0] = selectionPositions[closest0];
+					refPoints[1] = selectionPositions[closest1];
+					refPoints[2] = selectionPositions[closest2];
+					resolveReferenceDiamond(refPoints, uRef1, vRef11);
+					int32 diamondIndex = IndexNone;
+					if (closest0 != closest1 && closest1 != closest2 && closest0 != closest2
+						&& uRef1 % gridFrequency == 0 && uRef1 >= 0 && uRef1 < 5 * gridFrequency
+						&& (vRef11 == gridFrequency || vRef11 == 2 * gridFrequency))
+					{
+						diamondIndex = (uRef1 / gridFrequency) * 2 + vRef11 / gridFrequency - 1;
+					}
+					faceSelectionTableM[(closest0 * NumFaceSelectionPoints + closest1) * NumFaceSelectionPoints + closest2] = int8(diamondIndex);
+				}
+			}
+		}
+	}
+
+	template<typename T>
+	void FIcosahedralGrid::buildFaceBasis(const TVector3<T>& refPoint, const TVector3<T>& uVec, const TVector3<T>& vVec, TIcosahedronFaceBasis<T>& faceBasis) const
+	{
+		faceBasis.refPoint = refPoint;
+		uVec.toDirectionAndLength(faceBasis.uDir, faceBasis.uMag);
+		faceBasis.uMag /= gridFrequency;
+		vVec.toDirectionAndLength(faceBasis.vDir, faceBasis.vMag);
+		faceBasis.vMag /= gridFrequency;
+		faceBasis.uDotV = TVector3<T>::dotProduct(faceBasis.uDir, faceBasis.vDir);
+		faceBasis.divisor = 1 - std::pow(faceBasis.uDotV, T(2));
+
+		//the plane of the face, scaled so that projecting onto it is a single dot product
+		faceBasis.planeNormal = TVector3<T>::crossProduct(faceBasis.uDir, faceBasis.vDir);
+		faceBasis.planeNormal /= TVector3<T>::dotProduct(faceBasis.planeNormal, faceBasis.planeNormal);
+		faceBasis.planeR = TVector3<T>::dotProduct(faceBasis.planeNormal, refPoint);
+		if (faceBasis.planeR < 0)
+		{
+			faceBasis.planeNormal *= -1;
+			faceBasis.planeR *= -1;
+		}
+	}
+
+	void FIcosahedralGrid::resolveReferenceDiamond(const FGridIndex refPoints[3], int32& uRef1, int32& vRef11) const
+	{
+		//look at the uPositions and establish the reference square
+		uRef1 = std::numeric_limits<int32>::max();
+		int32 uRef2 = std::numeric_limits<int32>::max();
+		vRef11 = std::numeric_limits<int32>::max();
+		//only the lower v of each u column picks the diamond
+		int32 vRef21 = std::numeric_limits<int32>::max();
+		//if all of the refPoints VPositions are the same then we're effectively at one of the duplicate indexes
+		//take the closest one, use if as the URef1 VRef12 point, build from there
+		if (refPoints[0].vPos == refPoints[1].vPos
+			&& refPoints[1].vPos == refPoints[2].vPos)
+		{
+			FGridIndex refIndex1 = refPoints[0];
+			uRef1 = refIndex1.uPos;
+			FGridIndex refIndex2 = refPoints[1];
+			uRef2 = refIndex2.uPos;
+			if ((uRef1 > uRef2 && !(uRef1 == gridFrequency*4 && uRef2 == 0))
+				|| (uRef1 == 0 && uRef2 == gridFrequency*4))
+			{
+				uRef1 = refIndex2.uPos;
+				uRef2 = refIndex1.uPos;
+			}
+			//are we closer to the top index or the bottom index
+			if (refIndex1.vPos==gridFrequency)
+			{
+				//closer to bottom
+				vRef11 = gridFrequency;
+			}
+			else
+			{
+				//closer to top
+				vRef11 = 2 * gridFrequency;
+			}
+		}
+		else
+		{
+			for (int32 refNum = 0; refNum < 3; ++refNum)
+			{
+				const FGridIndex& refIndex = refPoints[refNum];
+				if (refIndex.uPos <= uRef1)
+				{
+					if (uRef1 != refIndex.uPos && uRef1 != std::numeric_limits<int32>::max())
+					{
+						//we need to move the existing uRef1 stuff to uRef2
+						uRef2 = uRef1;
+						vRef21 = vRef11;
+						vRef11 = std::numeric_limits<int32>::max();
+					}
+					uRef1 = refIndex.uPos;
+					vRef11 = std::min(vRef11, refIndex.vPos);
+				}
+				else
+				{
+					uRef2 = refIndex.uPos;
+					vRef21 = std::min(vRef21, refIndex.vPos);
+				}
+			}
+			//finally switch them if uref1 == 0
+			if (uRef1 == 0 && uRef2 == gridFrequency*4)
+			{
+				uRef1 = uRef2;
+				vRef11 = vRef21;
+			}
+		}
+	}
+
+	FVector3f FIcosahedralGrid::getNodeLocationOnSphereUV(const int32& uLoc, const int32& vLoc) const
+	{
+		return getTileLocationOnSphere(getRectilinearTile(uLoc, vLoc));
+	}
+
+	void FIcosahedralGrid::getNodeReferenceFrameUV(const int32& uLoc, const int32& vLoc, FVector3f& refPoint, FVector3f& uSpan, FVector3f& vSpan,
+		int32& localU, int32& localV) const
+	{
+		//find the reference vectors
+		int32 uRef1 = (uLoc / gridFrequency)*gridFrequency;
+		int32 uRef2 = uRef1 + gridFrequency;
+
+		//make sure we're mapping to a real triangle
+		if (uLoc % gridFrequency == 0
+			&& vLoc < gridFrequency)
+		{
+			uRef1 -= gridFrequency;
+			uRef2 -= gridFrequency;
+		}
+		//adjust for warp around
+		if (uRef2 >= 5 * gridFrequency)
+		{
+			uRef2 = 0;
+		}
+		if (uRef1 < 0)
+		{
+			uRef1 = 4 * gridFrequency;
+		}
+
+
+		int32 vRef11 = int32((vLoc / gridFrequency)*gridFrequency) + int32((uLoc==uRef1)?0:gridFrequency);
+		if (vLoc == getRectilinearColumnLength(uLoc)-1)
+		{
+			vRef11 -= gridFrequency;
+		}
+		int32 vRef12 = vRef11 + gridFrequency;
+
+		int32 vRef21 = vRef11 - gridFrequency;
+		int32 vRef22 = vRef12 - gridFrequency;
+
+
+		localU = (uLoc==0 && vLoc<gridFrequency)? gridFrequency:uLoc - uRef1;
+		localV = vLoc - int32(localU==0?vRef11:vRef21);
+		refPoint = gridReferencePointsM.at(getRectilinearTile(uRef1, vRef11));
+
+		uSpan = gridReferencePointsM.at(getRectilinearTile(uRef2, vRef22)) - refPoint;
+		if (localV >= localU)
+		{
+			//use the "upper vRef location
+			vSpan = gridReferencePointsM.at(getRectilinearTile(uRef1, vRef12)) - gridReferencePointsM.at(getRectilinearTile(uRef1, vRef11));
+		}
+		else
+		{
+			//use the lower vRef location
+			vSpan = gridReferencePointsM.at(getRectilinearTile(uRef2, vRef22)) - gridReferencePointsM.at(getRectilinearTile(uRef2, vRef21));
+		}
+	}
+
+	FVector3f FIcosahedralGrid::computeNodeLocationOnSphereUV(const int32& uLoc, const int32& vLoc) const
+	{
+		FVector3f refPoint, uDir, vDir;
+		int32 localU, localV;
+		getNodeReferenceFrameUV(uLoc, vLoc, refPoint, uDir, vDir, localU, localV);
+		uDir /= float(gridFrequency);
+		vDir /= float(gridFrequency);
+
+		//position on icosahedron
+		FVector3f icosahedronPos = refPoint + float(localU)*uDir + float(localV - localU)*vDir;
+
+		FVector3f unitSphereVec;
+		float currentMag;
+		icosahedronPos.toDirectionAndLength(unitSphereVec, currentMag);
+		return unitSphereVec;
+	}
+
+	void FIcosahedralGrid::buildTileLocationTables()
+	{
+		std::vector<float> locationsX(numNodes);
+		std::vector<float> locationsY(numNodes);
+		std::vector<float> locationsZ(numNodes);
+		for (int32 tileIndex = 0; tileIndex < numNodes; ++tileIndex)
+		{
+			const FGridIndex primaryPosition = getPrimaryGridIndex(tileIndex);
+			FVector3f tileLocation = computeNodeLocationOnSphereUV(primaryPosition.uPos, primaryPosition.vPos);
+			locationsX[tileIndex] = tileLocation.X;
+			locationsY[tileIndex] = tileLocation.Y;
+			locationsZ[tileIndex] = tileLocation.Z;
+		}
+		tileLocationsXM.assign(std::move(locationsX));
+		tileLocationsYM.assign(std::move(locationsY));
+		tileLocationsZM.assign(std::move(locationsZ));
+	}
+
+	void FIcosahedralGrid::buildDoubleTileLocationTables()
+	{
+		//the double precision copies aren't part of the topology cache, the first grid that wants them
+		//builds them into the shared topology and every later grid finds them there, the lock keeps a grid
+		//built at the same time from replacing the tables the first one already views
+		if (!settingsM.cacheDoublePrecisionLocations)
+		{
+			tileLocationsDoubleXM.view(nullptr, 0);
+			tileLocationsDoubleYM.view(nullptr, 0);
+			tileLocationsDoubleZM.view(nullptr, 0);
+			return;
+		}
+		std::lock_guard<std::mutex> tableLock(topologyM->lazyTableLock);
+		if (topologyM->tileLocationsDoubleX.Num() != numNodes)
+		{
+			fillDoubleTileLocationTables();
+		}
+		tileLocationsDoubleXM.view(topologyM->tileLocationsDoubleX);
+		tileLocationsDoubleYM.view(topologyM->tileLocationsDoubleY);
+		tileLocationsDoubleZM.view(topologyM->tileLocationsDoubleZ);
+	}
+
+	void FIcosahedralGrid::fillDoubleTileLocationTables()
+	{
+		std::vector<double> locationsX(numNodes);
+		std::vector<double> locationsY(numNodes);
+		std::vector<double> locationsZ(numNodes);
+		for (int32 tileIndex = 0; tileIndex < numNodes; ++tileIndex)
+		{
+			const FGridIndex primaryPosition = getPrimaryGridIndex(tileIndex);
+			//redo the interpolation across the icosahedron face in double precision
+			FVector3f refPoint, uSpan, vSpan;
+			int32 localU, localV;
+			getNodeReferenceFrameUV(primaryPosition.uPos, primaryPosition.vPos, refPoint, uSpan, vSpan, localU, localV);
+			const double uWeight = double(localU) / gridFrequency;
+			const double vWeight = double(localV - localU) / gridFrequency;
+			const double posX = double(refPoint.X) + uWeight*uSpan.X + vWeight*vSpan.X;
+			const double posY = double(refPoint.Y) + uWeight*uSpan.Y + vWeight*vSpan.Y;
+			const double posZ = double(refPoint.Z) + uWeight*uSpan.Z + vWeight*vSpan.Z;
+			const double posMagnitude = std::sqrt(posX*posX + posY*posY + posZ*posZ);
+			locationsX[tileIndex] = posX / posMagnitude;
+			locationsY[tileIndex] = posY / posMagnitude;
+			locationsZ[tileIndex] = posZ / posMagnitude;
+		}
+		topologyM->tileLocationsDoubleX.assign(std::move(locationsX));
+		topologyM->tileLocationsDoubleY.assign(std::move(locationsY));
+		topologyM->tileLocationsDoubleZ.assign(std::move(locationsZ));
+	}
+
+	void FIcosahedralGrid::buildDualCellTables()
+	{
+		//like the double precision locations the cells are built once into the shared topology, under the same lock
+		if (!settingsM.cacheDualCellGeometry)
+		{
+			tileCellAreasM.view(nullptr, 0);
+			tileCellEdgeLengthsM.view(nullptr, 0);
+			tileCellCornersM.view(nullptr, 0);
+			return;
+		}
+		std::lock_guard<std::mutex> tableLock(topologyM->lazyTableLock);
+		if (topologyM->tileCellAreas.Num() != numNodes)
+		{
+			fillDualCellTables();
+		}
+		tileCellAreasM.view(topologyM->tileCellAreas);
+		tileCellEdgeLengthsM.view(topologyM->tileCellEdgeLengths);
+		tileCellCornersM.view(topologyM->tileCellCorners);
+	}
+
+	void FIcosahedralGrid::fillDualCellTables()
+	{
+		const int64 numNeighborEntries = tileNeighborOffsetsM[numNodes];
+		std::vector<float> cellAreas(numNodes);
+		std::vector<float> cellEdgeLengths(numNeighborEntries);
+		std::vector<FVector3f> cellCorners(numNeighborEntries);
+		//everything is done in double precision, at high frequencies the corners of a cell are too close together for floats
+		const bool hasDoubleLocations = tileLocationsDoubleXM.Num() == numNodes;
+		auto getDoubleTileLocation = [&](const int32& tileIndex)
+		{
+			if (hasDoubleLocations)
+			{
+				return TVector3<double>(tileLocationsDoubleXM[tileIndex], tileLocationsDoubleYM[tileIndex], tileLocationsDoubleZM[tileIndex]);
+			}
+			return TVector3<double>(tileLocationsXM[tileIndex], tileLocationsYM[tileIndex], tileLocationsZM[tileIndex]);
+		};
+		const int32 TilesPerChunk = 4096;
+		const int32 numChunks = (numNodes + TilesPerChunk - 1) / TilesPerChunk;
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			TVector3<double> cornerLocations[6];
+			const int32 chunkEnd = std::min(numNodes, (chunkIndex + 1)*TilesPerChunk);
+			for (int32 tileIndex = chunkIndex*TilesPerChunk; tileIndex < chunkEnd; ++tileIndex)
+			{
+				const FTileIndexView tileNeighbors = getTileNeighborView(tileIndex);
+				const int32 numNeighbors = tileNeighbors.Num();
+				const TVector3<double> tileLocation = getDoubleTileLocation(tileIndex);
+				//the corner between two neighbors is the circumcenter of the triangle they make with the tile,
+				//the normal of that triangle's plane
+				for (int32 cornerNum = 0; cornerNum < numNeighbors; ++cornerNum)
+				{
+					const TVector3<double> firstNeighbor = getDoubleTileLocation(tileNeighbors[cornerNum]);
+					const TVector3<double> secondNeighbor = getDoubleTileLocation(tileNeighbors[(cornerNum + 1) % numNeighbors]);
+					//the normal is tiny at high frequencies, too short for getSafeNormal
+					TVector3<double> cornerLocation = TVector3<double>::crossProduct(firstNeighbor - tileLocation, secondNeighbor - tileLocation);
+					cornerLocation /= cornerLocation.size();
+					if (TVector3<double>::dotProduct(cornerLocation, tileLocation) < 0)
+					{
+						cornerLocation = -cornerLocation;
+					}
+					cornerLocations[cornerNum] = cornerLocation;
+				}
+				//the cell is a fan of spherical triangles around the tile, each edge is the arc between two corners
+				double cellArea = 0;
+				const int64 firstEntry = tileNeighborOffsetsM[tileIndex];
+				for (int32 edgeNum = 0; edgeNum < numNeighbors; ++edgeNum)
+				{
+					const TVector3<double>& edgeStart = cornerLocations[(edgeNum + numNeighbors - 1) % numNeighbors];
+					const TVector3<double>& edgeEnd = cornerLocations[edgeNum];
+					cellEdgeLengths[firstEntry + edgeNum] = float(std::atan2(TVector3<double>::crossProduct(edgeStart, edgeEnd).size(),
+						TVector3<double>::dotProduct(edgeStart, edgeEnd)));
+					cellCorners[firstEntry + edgeNum] = FVector3f(float(edgeEnd.X), float(edgeEnd.Y), float(edgeEnd.Z));
+					//spherical excess of the triangle from its vertices, tan(E/2) = |a.(b x c)| / (1 + a.b + b.c + c.a)
+					const double tripleProduct = TVector3<double>::dotProduct(tileLocation, TVector3<double>::crossProduct(edgeStart, edgeEnd));
+					const double denominator = 1 + TVector3<double>::dotProduct(tileLocation, edgeStart) + TVector3<double>::dotProduct(edgeStart, edgeEnd)
+						+ TVector3<double>::dotProduct(edgeEnd, tileLocation);
+					cellArea += 2 * std::atan2(std::abs(tripleProduct), denominator);
+				}
+				cellAreas[tileIndex] = float(cellArea);
+			}
+		});
+		topologyM->tileCellAreas.assign(std::move(cellAreas));
+		topologyM->tileCellEdgeLengths.assign(std::move(cellEdgeLengths));
+		topologyM->tileCellCorners.assign(std::move(cellCorners));
+	}
+
+	int32 FIcosahedralGrid::getNumGridPositions(const int32& tileIndex) const
+	{
+		auto seamSlot = seamTileSlotsM.find(tileIndex);
+		if (seamSlot == seamTileSlotsM.end())
+		{
+			return 1;
+		}
+		return 1 + seamPositionOffsetsM[seamSlot->second + 1] - seamPositionOffsetsM[seamSlot->second];
+	}
+
+	FGridIndex FIcosahedralGrid::getGridIndex(const int32& tileIndex, const int32& positionNum) const
+	{
+		if (positionNum == 0)
+		{
+			return getPrimaryGridIndex(tileIndex);
+		}
+		return unpackGridIndex(seamPositionsM[seamPositionOffsetsM[seamTileSlotsM.at(tileIndex)] + positionNum - 1]);
+	}
+
+	std::vector<int32> FIcosahedralGrid::mergeTileNeighborIndexes(const int32& tileIndex) const
+	{
+		std::vector<int32> neighborList;
+
+		const int32 numGridPositions = getNumGridPositions(tileIndex);
+		for (int32 positionNum = 0; positionNum < numGridPositions; ++positionNum)
+		{
+			std::vector<int32> tilesInRange = getIndexNeighbors(getGridIndex(tileIndex, positionNum));
+			//combine the tilesInRangeList with the neighborList such that the order is maintained
+			//start by finding a shared neighbor
+			int32 startLoc = 0;
+			int32 tIRIndex = 0;
+			int32 numCornersToTransfer = 5;
+			if (neighborList.size()!=0)
+			{
+				startLoc = std::numeric_limits<int32>::min();
+				for (; tIRIndex < int32(tilesInRange.size()); ++tIRIndex)
+				{
+					int32 tileIndex = tilesInRange[tIRIndex];
+					if (tileIndex != std::numeric_limits<int32>::min())
+					{
+						auto sharedNeighbor = std::find(neighborList.begin(), neighborList.end(), tileIndex);
+						startLoc = sharedNeighbor != neighborList.end() ? int32(sharedNeighbor - neighborList.begin()) : IndexNone;
+						if (startLoc >= 0)
+						{
+							break;
+						}
+					}
+				}
+				++startLoc;
+				++tIRIndex;
+			}
+			else
+			{
+				neighborList.assign(6, std::numeric_limits<int32>::min());
+				numCornersToTransfer = 6;
+			}
+			for (int numCorners = 0; numCorners < numCornersToTransfer; ++numCorners, ++startLoc, ++tIRIndex)
+			{
+				if (tIRIndex == 6)
+				{
+					tIRIndex = 0;
+				}
+				if (startLoc == 6)
+				{
+					startLoc = 0;
+				}
+				if (tilesInRange[tIRIndex] != std::numeric_limits<int32>::min())
+				{
+					if (std::find(neighborList.begin(), neighborList.end(), tilesInRange[tIRIndex]) != neighborList.end())
+					{
+						continue;
+					}
+					neighborList[startLoc] = tilesInRange[tIRIndex];
+				}
+			}
+		}
+		neighborList.erase(std::remove(neighborList.begin(), neighborList.end(), std::numeric_limits<int32>::min()), neighborList.end());
+		return neighborList;
+	}
+
+	std::vector<int32> FIcosahedralGrid::getIndexNeighbors(const FGridIndex &gridIndex) const
+	{
+		int32 nextU = gridIndex.uPos;
+		int32 nextV = gridIndex.vPos;
+		int32 myIndex = getRectilinearTile(nextU, nextV);
+		std::vector<int32> tilesInRange(6, std::numeric_limits<int32>::min());
+		//our Manhattan distance plane is u-v+w=0
+		//u1,v0
+		incrementU(nextU, nextV);
+
+		if (nextV >= 0)
+		{
+			tilesInRange[0] = (getRectilinearTile(nextU, nextV));
+			if (tilesInRange[0] == myIndex)
+			{
+				tilesInRange[0] = std::numeric_limits<int32>::min();
+			}
+
+		}
+		//u1,v1
+		++nextV;
+		if (nextV >= 0 && nextV < getRectilinearColumnLength(nextU))
+		{
+			tilesInRange[1] = (getRectilinearTile(nextU, nextV));
+			if (tilesInRange[1] == myIndex)
+			{
+				tilesInRange[1] = std::numeric_limits<int32>::min();
+			}
+		}
+		//u0,v1
+		decrementU(nextU, nextV);
+
+		if (nextV < getRectilinearColumnLength(nextU))
+		{
+			tilesInRange[2] = (getRectilinearTile(nextU, nextV));
+			if (tilesInRange[2] == myIndex)
+			{
+				tilesInRange[2] = std::numeric_limits<int32>::min();
+			}
+		}
+		//u-1,v0
+		decrementU(nextU, nextV);
+		--nextV;
+		if (nextV < getRectilinearColumnLength(nextU))
+		{
+			tilesInRange[3] = (getRectilinearTile(nextU, nextV));
+			if (tilesInRange[3] == myIndex)
+			{
+				tilesInRange[3] = std::numeric_limits<int32>::min();
+			}
+		}
+		//u-1,v-1
+		--nextV;
+		if (nextV >= 0 && nextV < getRectilinearColumnLength(nextU))
+		{
+			tilesInRange[4] = (getRectilinearTile(nextU, nextV));
+			if (tilesInRange[4] == myIndex)
+			{
+				tilesInRange[4] = std::numeric_limits<int32>::min();
+			}
+		}
+		//u0,v-1
+		incrementU(nextU, nextV);
+		if (nextV >= 0)
+		{
+			tilesInRange[5] = (getRectilinearTile(nextU, nextV));
+			if (tilesInRange[5] == myIndex)
+			{
+				tilesInRange[5] = std::numeric_limits<int32>::min();
+			}
+		}
+		return tilesInRange;
+	}
+
+	void FIcosahedralGrid::decrementU(int32 &nextU, int32 &nextV) const
+	{
+		--nextU;
+		if (nextU%gridFrequency == 0)
+		{
+			nextV += gridFrequency;
+		}
+		if (nextU < 0)
+		{
+			nextU += gridFrequency * 5;
+		}
+	}
+
+	void FIcosahedralGrid::incrementU(int32 &nextU, int32 &nextV) const
+	{
+		int32 oldPhase = ceilToInt(nextU*1.0 / gridFrequency);
+		++nextU;
+		if (ceilToInt(nextU*1.0 / gridFrequency) > oldPhase)
+		{
+			nextV -= gridFrequency;
+		}
+		if (nextU == gridFrequency * 5)
+		{
+			nextU = 0;
+		}
+	}
+
+	std::vector<int32> FIcosahedralGrid::getTileIndexesNStepsAwayFromIndex(const int32& tileIndex, const int32& numSteps) const
+	{
+		std::vector<int32> tileIndexSet;
+		if (settingsM.cacheDiskStencils)
+		{
+			std::shared_ptr<const FDiskStencilSet> diskStencils = getDiskStencilSet(numSteps);
+			if (diskStencils)
+			{
+				diskStencils->getDisk(tileIndex, tileIndexSet);
+				return tileIndexSet;
+			}
+		}
+		enumerateTileDisk(tileIndex, numSteps, tileIndexSet);
+		return tileIndexSet;
+	}
+
+	void FIcosahedralGrid::enumerateTileDisk(const int32& tileIndex, const int32& numSteps, std::vector<int32>& outTileIndexes) const
+	{
+		outTileIndexes.clear();
+		outTileIndexes.reserve(1 + 3 * numSteps*(numSteps + 1));
+		if (isDiskFreeOfPentagons(tileIndex, numSteps))
+		{
+			walkHexDisk(tileIndex, numSteps, outTileIndexes);
+			return;
+		}
+
+		//close to a pentagon the rings aren't regular, flood the disk using a set local to the result instead
+		std::unordered_set<int32> visitedTiles;
+		visitedTiles.reserve(1 + 3 * numSteps*(numSteps + 1));
+		outTileIndexes.push_back(tileIndex);
+		visitedTiles.insert(tileIndex);
+		int32 frontierStart = 0;
+		for (int32 step = 0; step < numSteps; ++step)
+		{
+			const int32 frontierEnd = int32(outTileIndexes.size());
+			for (int32 frontierIndex = frontierStart; frontierIndex < frontierEnd; ++frontierIndex)
+			{
+				for (const int32& neighborIndex : getTileNeighborView(outTileIndexes[frontierIndex]))
+				{
+					if (visitedTiles.insert(neighborIndex).second)
+					{
+						outTileIndexes.push_back(neighborIndex);
+					}
+				}
+			}
+			frontierStart = frontierEnd;
+		}
+	}
+
+	std::shared_ptr<const FDiskStencilSet> FIcosahedralGrid::getDiskStencilSet(const int32& radius) const
+	{
+		if (radius < 0 || radius > MaxDiskStencilRadius || radius * DiskStencilFrequencyPerRadius > gridFrequency)
+		{
+			return std::shared_ptr<const FDiskStencilSet>();
+		}
+		const int64 budgetBytes = int64(settingsM.diskStencilCacheBudgetMB) * 1024 * 1024;
+		{
+			std::lock_guard<std::mutex> cacheLock(diskStencilLockM);
+			auto cachedStencils = diskStencilSetsM.find(radius);
+			if (cachedStencils != diskStencilSetsM.end())
+			{
+				cachedStencils->second.lastUseStamp = ++diskStencilUseCounterM;
+				return cachedStencils->second.stencilSet;
+			}
+			//every tile needs at least its pattern index, don't bother building what can never fit
+			if (uncachedDiskRadiiM.count(radius) != 0 || buildingDiskRadiiM.count(radius) != 0 || int64(numNodes) * int64(sizeof(int32)) > budgetBytes)
+			{
+				return std::shared_ptr<const FDiskStencilSet>();
+			}
+			buildingDiskRadiiM.insert(radius);
+		}
+
+		//another grid with the same topology may already hold the stencils for this radius, otherwise build them
+		//without the lock so the other threads keep walking their disks in the meantime
+		std::shared_ptr<const FDiskStencilSet> newStencils = topologyM->findDiskStencilSet(radius);
+		if (!newStencils)
+		{
+			newStencils = buildDiskStencilSet(radius, budgetBytes);
+		}
+
+		std::lock_guard<std::mutex> cacheLock(diskStencilLockM);
+		buildingDiskRadiiM.erase(radius);
+		const int64 newStencilBytes = newStencils ? newStencils->getAllocatedSize() : budgetBytes + 1;
+		if (newStencilBytes > budgetBytes)
+		{
+			uncachedDiskRadiiM.insert(radius);
+			return std::shared_ptr<const FDiskStencilSet>();
+		}
+		//make room by evicting the least recently used radii, anyone still holding them keeps their copy alive
+		while (diskStencilBytesM + newStencilBytes > budgetBytes)
+		{
+			auto oldestEntry = diskStencilSetsM.begin();
+			for (auto stencilEntry = diskStencilSetsM.begin(); stencilEntry != diskStencilSetsM.end(); ++stencilEntry)
+			{
+				if (stencilEntry->second.lastUseStamp < oldestEntry->second.lastUseStamp)
+				{
+					oldestEntry = stencilEntry;
+				}
+			}
+			diskStencilBytesM -= oldestEntry->second.stencilSet->getAllocatedSize();
+			diskStencilSetsM.erase(oldestEntry);
+		}
+		FDiskStencilCacheEntry newEntry;
+		newEntry.stencilSet = topologyM->shareDiskStencilSet(newStencils);
+		newEntry.lastUseStamp = ++diskStencilUseCounterM;
+		diskStencilSetsM[radius] = newEntry;
+		diskStencilBytesM += newStencilBytes;
+		return newEntry.stencilSet;
+	}
+
+	void FIcosahedralGrid::clearDiskStencilCache()
+	{
+		std::lock_guard<std::mutex> cacheLock(diskStencilLockM);
+		diskStencilSetsM.clear();
+		uncachedDiskRadiiM.clear();
+		buildingDiskRadiiM.clear();
+		diskStencilBytesM = 0;
+	}
+
+	namespace
+	{
+		//FNV-1a over the bytes of a pattern, only used to bucket patterns before comparing them
+		uint32 hashDiskPattern(const int32* patternOffsets, int32 numOffsets)
+		{
+			const uint8* patternBytes = reinterpret_cast<const uint8*>(patternOffsets);
+			uint32 patternHash = 2166136261u;
+			for (size_t byteNum = 0; byteNum < numOffsets * sizeof(int32); ++byteNum)
+			{
+				patternHash = (patternHash ^ patternBytes[byteNum]) * 16777619u;
+			}
+			return patternHash;
+		}
+	}
+
+	std::shared_ptr<FDiskStencilSet> FIcosahedralGrid::buildDiskStencilSet(const int32& radius, const int64& budgetBytes) const
+	{
+		std::shared_ptr<FDiskStencilSet> diskStencils = std::make_shared<FDiskStencilSet>();
+		diskStencils->radius = radius;
+		diskStencils->tilePatterns.resize(numNodes);
+
+		//every chunk of tiles collects its own distinct patterns in parallel
+		struct FChunkPatterns
+		{
+			std::vector<int32> patternOffsets;
+			std::vector<int32> patternTileOffsets;
+			std::vector<uint32> patternHashes;
+		};
+		const int32 TilesPerChunk = 4096;
+		const int32 numChunks = (numNodes + TilesPerChunk - 1) / TilesPerChunk;
+		std::vector<FChunkPatterns> chunkPatterns(numChunks);
+		//the chunks count every pattern they keep against the budget, the merged table is never larger than all of them together
+		std::atomic<int64> patternBytes(int64(numNodes) * int64(sizeof(int32)));
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			FChunkPatterns& chunk = chunkPatterns[chunkIndex];
+			std::unordered_map<uint32, std::vector<int32>> patternsByHash;
+			std::vector<int32> diskTiles;
+			chunk.patternOffsets.push_back(0);
+			const int32 chunkEnd = std::min(numNodes, (chunkIndex + 1)*TilesPerChunk);
+			for (int32 tileIndex = chunkIndex*TilesPerChunk; tileIndex < chunkEnd && patternBytes.load(std::memory_order_relaxed) <= budgetBytes; ++tileIndex)
+			{
+				enumerateTileDisk(tileIndex, radius, diskTiles);
+				for (int32& diskTile : diskTiles)
+				{
+					diskTile -= tileIndex;
+				}
+				const int32 numDiskTiles = int32(diskTiles.size());
+				const uint32 patternHash = hashDiskPattern(diskTiles.data(), numDiskTiles);
+				std::vector<int32>& hashedPatterns = patternsByHash[patternHash];
+				int32 tilePattern = IndexNone;
+				for (const int32& candidatePattern : hashedPatterns)
+				{
+					const int32 candidateStart = chunk.patternOffsets[candidatePattern];
+					if (chunk.patternOffsets[candidatePattern + 1] - candidateStart == numDiskTiles
+						&& std::equal(diskTiles.begin(), diskTiles.end(), chunk.patternTileOffsets.begin() + candidateStart))
+					{
+						tilePattern = candidatePattern;
+						break;
+					}
+				}
+				if (tilePattern == IndexNone)
+				{
+					tilePattern = int32(chunk.patternHashes.size());
+					hashedPatterns.push_back(tilePattern);
+					chunk.patternHashes.push_back(patternHash);
+					chunk.patternTileOffsets.insert(chunk.patternTileOffsets.end(), diskTiles.begin(), diskTiles.end());
+					chunk.patternOffsets.push_back(int32(chunk.patternTileOffsets.size()));
+					patternBytes.fetch_add(int64(numDiskTiles + 1) * int64(sizeof(int32)), std::memory_order_relaxed);
+				}
+				diskStencils->tilePatterns[tileIndex] = tilePattern;
+			}
+		});
+		if (patternBytes.load(std::memory_order_relaxed) > budgetBytes)
+		{
+			return std::shared_ptr<FDiskStencilSet>();
+		}
+
+		//merge the chunk patterns into one table and renumber the tiles to match
+		std::unordered_map<uint32, std::vector<int32>> patternsByHash;
+		diskStencils->patternOffsets.push_back(0);
+		for (int32 chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+		{
+			const FChunkPatterns& chunk = chunkPatterns[chunkIndex];
+			std::vector<int32> mergedPatterns(chunk.patternHashes.size());
+			for (int32 chunkPattern = 0; chunkPattern < int32(chunk.patternHashes.size()); ++chunkPattern)
+			{
+				const int32 chunkStart = chunk.patternOffsets[chunkPattern];
+				const int32 patternLength = chunk.patternOffsets[chunkPattern + 1] - chunkStart;
+				std::vector<int32>& hashedPatterns = patternsByHash[chunk.patternHashes[chunkPattern]];
+				mergedPatterns[chunkPattern] = IndexNone;
+				for (const int32& candidatePattern : hashedPatterns)
+				{
+					const int32 candidateStart = diskStencils->patternOffsets[candidatePattern];
+					if (diskStencils->patternOffsets[candidatePattern + 1] - candidateStart == patternLength
+						&& std::equal(chunk.patternTileOffsets.begin() + chunkStart, chunk.patternTileOffsets.begin() + chunkStart + patternLength,
+							diskStencils->patternTileOffsets.begin() + candidateStart))
+					{
+						mergedPatterns[chunkPattern] = candidatePattern;
+						break;
+					}
+				}
+				if (mergedPatterns[chunkPattern] == IndexNone)
+				{
+					mergedPatterns[chunkPattern] = int32(diskStencils->patternOffsets.size()) - 1;
+					hashedPatterns.push_back(mergedPatterns[chunkPattern]);
+					diskStencils->patternTileOffsets.insert(diskStencils->patternTileOffsets.end(),
+						chunk.patternTileOffsets.begin() + chunkStart, chunk.patternTileOffsets.begin() + chunkStart + patternLength);
+					diskStencils->patternOffsets.push_back(int32(diskStencils->patternTileOffsets.size()));
+				}
+			}
+			const int32 chunkEnd = std::min(numNodes, (chunkIndex + 1)*TilesPerChunk);
+			for (int32 tileIndex = chunkIndex*TilesPerChunk; tileIndex < chunkEnd; ++tileIndex)
+			{
+				diskStencils->tilePatterns[tileIndex] = mergedPatterns[diskStencils->tilePatterns[tileIndex]];
+			}
+		}
+		diskStencils->patternOffsets.shrink_to_fit();
+		diskStencils->patternTileOffsets.shrink_to_fit();
+		return diskStencils;
+	}
+
+	void FIcosahedralGrid::floodTileIndexesNStepsAway(const int32& tileIndex, const int32& numSteps, FTileVisitScratch& visitedTiles, std::vector<int32>& outTileIndexes) const
+	{
+		visitedTiles.beginSearch(numNodes);
+		outTileIndexes.clear();
+		outTileIndexes.push_back(tileIndex);
+		visitedTiles.markVisited(tileIndex);
+		int32 frontierStart = 0;
+		for (int32 step = 0; step < numSteps && frontierStart < int32(outTileIndexes.size()); ++step)
+		{
+			frontierStart = expandTileFrontier(outTileIndexes, frontierStart, visitedTiles);
+		}
+	}
+
+	int32 FIcosahedralGrid::findNearestTile(const FVector3f& direction) const
+	{
+		const FVector3f unitDirection = direction.getSafeNormal();
+		int32 nearestTile = mapPosToTileIndex(unitDirection);
+		float nearestDot = FVector3f::dotProduct(unitDirection, getTileLocationOnSphere(nearestTile));
+		//the mapping rounds in the plane of a face, which can be a tile off the closest center near the edges of a cell
+		for (bool movedCloser = true; movedCloser;)
+		{
+			movedCloser = false;
+			for (const int32& neighborIndex : getTileNeighborView(nearestTile))
+			{
+				const float neighborDot = FVector3f::dotProduct(unitDirection, getTileLocationOnSphere(neighborIndex));
+				if (neighborDot > nearestDot)
+				{
+					nearestTile = neighborIndex;
+					nearestDot = neighborDot;
+					movedCloser = true;
+					break;
+				}
+			}
+		}
+		return nearestTile;
+	}
+
+	void FIcosahedralGrid::getTilesWithinAngle(const FVector3f& direction, const float& arcAngle, FTileVisitScratch& visitedTiles,
+		std::vector<int32>& outTileIndexes) const
+	{
+		//every tile but the nearest has a neighbor closer to the direction, so the tiles in the cap are connected
+		//and a flood from the nearest tile that stops at the edge of the cap finds all of them
+		outTileIndexes.clear();
+		visitedTiles.beginSearch(numNodes);
+		const FVector3f unitDirection = direction.getSafeNormal();
+		const float minDot = arcAngle < Pi ? std::cos(arcAngle) : -2.0f;
+		const int32 nearestTile = findNearestTile(unitDirection);
+		if (FVector3f::dotProduct(unitDirection, getTileLocationOnSphere(nearestTile)) < minDot)
+		{
+			return;
+		}
+		outTileIndexes.push_back(nearestTile);
+		visitedTiles.markVisited(nearestTile);
+		for (size_t capIndex = 0; capIndex < outTileIndexes.size(); ++capIndex)
+		{
+			for (const int32& neighborIndex : getTileNeighborView(outTileIndexes[capIndex]))
+			{
+				if (visitedTiles.markVisited(neighborIndex)
+					&& FVector3f::dotProduct(unitDirection, getTileLocationOnSphere(neighborIndex)) >= minDot)
+				{
+					outTileIndexes.push_back(neighborIndex);
+				}
+			}
+		}
+	}
+
+	void FIcosahedralGrid::getNearestTiles(const FVector3f& direction, const int32& numTiles, FTileVisitScratch& visitedTiles,
+		std::vector<int32>& outTileIndexes) const
+	{
+		//for the same reason the k nearest tiles are connected, growing best first from the nearest tile
+		//hands them out in order while only ever holding their ring of neighbors
+		outTileIndexes.clear();
+		if (numTiles <= 0)
+		{
+			return;
+		}
+		visitedTiles.beginSearch(numNodes);
+		const FVector3f unitDirection = direction.getSafeNormal();
+		std::priority_queue<std::pair<float, int32>> candidateTiles;
+		const int32 nearestTile = findNearestTile(unitDirection);
+		visitedTiles.markVisited(nearestTile);
+		candidateTiles.push(std::make_pair(FVector3f::dotProduct(unitDirection, getTileLocationOnSphere(nearestTile)), nearestTile));
+		const int32 numFoundTiles = std::min(numTiles, numNodes);
+		outTileIndexes.reserve(numFoundTiles);
+		while (int32(outTileIndexes.size()) < numFoundTiles)
+		{
+			const int32 closestTile = candidateTiles.top().second;
+			candidateTiles.pop();
+			outTileIndexes.push_back(closestTile);
+			for (const int32& neighborIndex : getTileNeighborView(closestTile))
+			{
+				if (visitedTiles.markVisited(neighborIndex))
+				{
+					candidateTiles.push(std::make_pair(FVector3f::dotProduct(unitDirection, getTileLocationOnSphere(neighborIndex)), neighborIndex));
+				}
+			}
+		}
+	}
+
+	int32 FIcosahedralGrid::expandTileFrontier(std::vector<int32>& tileIndexSet, const int32& frontierStart, FTileVisitScratch& visitedTiles) const
+	{
+		const int32 frontierEnd = int32(tileIndexSet.size());
+		for (int32 frontierIndex = frontierStart; frontierIndex < frontierEnd; ++frontierIndex)
+		{
+			for (const int32& neighborIndex : getTileNeighborView(tileIndexSet[frontierIndex]))
+			{
+				if (visitedTiles.markVisited(neighborIndex))
+				{
+					tileIndexSet.push_back(neighborIndex);
+				}
+			}
+		}
+		return frontierEnd;
+	}
+
+	void FIcosahedralGrid::buildPentagonTable()
+	{
+		pentagonTileIndexesM.clear();
+		for (const auto& referencePoint : gridReferencePointsM)
+		{
+			pentagonTileIndexesM.push_back(referencePoint.first);
+		}
+	}
+
+	void FIcosahedralGrid::measureMaxNeighborAngle()
+	{
+		//the widest step between neighbors bounds how far a disk can reach across the sphere
+		float minNeighborDot = 1.0;
+		for (int32 tileIndex = 0; tileIndex < numNodes; ++tileIndex)
+		{
+			const FVector3f tileLocation = getTileLocationOnSphere(tileIndex);
+			for (const int32& neighborIndex : getTileNeighborView(tileIndex))
+			{
+				minNeighborDot = std::min(minNeighborDot, FVector3f::dotProduct(tileLocation, getTileLocationOnSphere(neighborIndex)));
+			}
+		}
+		maxNeighborAngleM = std::acos(clampValue(minNeighborDot, -1.0f, 1.0f));
+	}
+
+	bool FIcosahedralGrid::isDiskFreeOfPentagons(const int32& centerTile, const int32& numSteps) const
+	{
+		//every step covers at most maxNeighborAngleM, so a pentagon further away than numSteps
+		//of those can't be inside the disk, the extra half step absorbs rounding in the angles
+		const float diskAngle = (numSteps + 0.5f)*maxNeighborAngleM;
+		if (diskAngle >= Pi)
+		{
+			return false;
+		}
+		const float minPentagonDot = std::cos(diskAngle);
+		const FVector3f centerLocation = getTileLocationOnSphere(centerTile);
+		for (const int32& pentagonIndex : pentagonTileIndexesM)
+		{
+			if (FVector3f::dotProduct(centerLocation, getTileLocationOnSphere(pentagonIndex)) >= minPentagonDot)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void FIcosahedralGrid::stepHexTile(int32& tileIndex, int32& heading) const
+	{
+		//the neighbor rings all wind the same way, so carrying on straight through the next tile
+		//means leaving through the slot opposite the one we came in by
+		const int32 nextTile = tileNeighborsM[tileNeighborOffsetsM[tileIndex] + heading];
+		FTileIndexView nextNeighbors = getTileNeighborView(nextTile);
+		int32 entrySlot = 0;
+		while (nextNeighbors[entrySlot] != tileIndex)
+		{
+			++entrySlot;
+		}
+		heading = entrySlot < 3 ? entrySlot + 3 : entrySlot - 3;
+		tileIndex = nextTile;
+	}
+
+	void FIcosahedralGrid::walkHexDisk(const int32& centerTile, const int32& numSteps, std::vector<int32>& outTileIndexes) const
+	{
+		outTileIndexes.push_back(centerTile);
+		//the spoke runs straight out from the center and every ring starts where it crosses the ring
+		int32 spokeTile = centerTile;
+		int32 spokeHeading = 0;
+		for (int32 ringRadius = 1; ringRadius <= numSteps; ++ringRadius)
+		{
+			stepHexTile(spokeTile, spokeHeading);
+			//turn a third of the way round off the spoke and walk the six sides of the ring
+			int32 ringTile = spokeTile;
+			int32 ringHeading = (spokeHeading + 2) % 6;
+			for (int32 ringSide = 0; ringSide < 6; ++ringSide)
+			{
+				for (int32 sideStep = 0; sideStep < ringRadius; ++sideStep)
+				{
+					outTileIndexes.push_back(ringTile);
+					stepHexTile(ringTile, ringHeading);
+				}
+				ringHeading = ringHeading == 5 ? 0 : ringHeading + 1;
+			}
+			HEXPLANET_CHECK_SLOW(ringTile == spokeTile);
+		}
+	}
+
+	void FIcosahedralGrid::expandTileSet(std::vector<int32>& tileIndexSet, std::vector<bool>& tileAvailability) const
+	{
+		int32 startNumIndexes = int32(tileIndexSet.size());
+		for (int32 currentIndex = 0; currentIndex < startNumIndexes; ++currentIndex)
+		{
+			int32 tileNum = tileIndexSet[currentIndex];
+			for (const int32& tileIndex : getTileNeighborView(tileNum))
+			{
+				if (tileAvailability[tileIndex])
+				{
+					tileIndexSet.push_back(tileIndex);
+					tileAvailability[tileIndex] = false;
+				}
+			}
+		}
+	}
+
+	namespace
+	{
+		//steps between two positions of one flat sheet of the grid, w = dv - du is the third axial coordinate
+		HEXPLANET_FORCEINLINE int32 axialGridDistance(const int32& du, const int32& dv)
+		{
+			return std::max(std::max(std::abs(du), std::abs(dv)), std::abs(dv - du));
+		}
+
+		//atan2 of the sine and cosine keeps its precision for close and for opposite tiles, acos of the dot product loses both
+		HEXPLANET_FORCEINLINE float unitVectorAngle(const float& ax, const float& ay, const float& az, const float& bx, const float& by, const float& bz)
+		{
+			const float crossX = ay * bz - az * by;
+			const float crossY = az * bx - ax * bz;
+			const float crossZ = ax * by - ay * bx;
+			return std::atan2(std::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ), ax * bx + ay * by + az * bz);
+		}
+
+		//turns an unfolding a sixth of a turn about (uCenter, vCenter), counterclockwise takes the u axis onto the u = v diagonal
+		void rotateStripUnfolding(FStripUnfolding& unfolding, const int32& uCenter, const int32& vCenter, const bool& counterclockwise)
+		{
+			const int32 rows[3][2] = { { unfolding.uu, unfolding.vu },{ unfolding.uv, unfolding.vv },
+				{ unfolding.uOffset - uCenter, unfolding.vOffset - vCenter } };
+			int32 rotated[3][2];
+			for (int32 rowNum = 0; rowNum < 3; ++rowNum)
+			{
+				rotated[rowNum][0] = counterclockwise ? rows[rowNum][0] - rows[rowNum][1] : rows[rowNum][1];
+				rotated[rowNum][1] = counterclockwise ? rows[rowNum][0] : rows[rowNum][1] - rows[rowNum][0];
+			}
+			unfolding.uu = rotated[0][0];
+			unfolding.vu = rotated[0][1];
+			unfolding.uv = rotated[1][0];
+			unfolding.vv = rotated[1][1];
+			unfolding.uOffset = rotated[2][0] + uCenter;
+			unfolding.vOffset = rotated[2][1] + vCenter;
+		}
+	}
+
+	void FIcosahedralGrid::buildStripUnfoldingTable()
+	{
+		//shifting every column up by f at each strip boundary turns the grid into five strips, each one (f, f) along
+		//from the last, neighboring strips share the equatorial edge between their pentagons and are also glued
+		//around the lower pentagon at (f, 2f) and the upper pentagon at (f, 3f) of the boundary they meet on,
+		//a shortest path may go through any of those three joins at each boundary it crosses
+		const int32 f = gridFrequency;
+		stripUnfoldingsM.clear();
+		stripUnfoldingOffsetsM.clear();
+		for (int32 stripOffset = -MaxStripUnfoldingOffset; stripOffset <= MaxStripUnfoldingOffset; ++stripOffset)
+		{
+			const int32 firstUnfolding = int32(stripUnfoldingsM.size());
+			stripUnfoldingOffsetsM.push_back(firstUnfolding);
+			const int32 numBoundaries = std::abs(stripOffset);
+			int32 numJoinChoices = 1;
+			for (int32 boundaryNum = 0; boundaryNum < numBoundaries; ++boundaryNum)
+			{
+				numJoinChoices *= 3;
+			}
+			for (int32 joinChoice = 0; joinChoice < numJoinChoices; ++joinChoice)
+			{
+				FStripUnfolding unfolding = { 1, 0, 0, 1, 0, 0 };
+				//glue the far strip on first and carry it back boundary by boundary towards strip 0
+				int32 remainingChoices = joinChoice;
+				int32 boundaryDivisor = numJoinChoices / 3;
+				for (int32 boundaryNum = numBoundaries - 1; boundaryNum >= 0; --boundaryNum)
+				{
+					//0 crosses the equatorial edge, 1 goes round the upper pentagon, 2 round the lower one
+					const int32 join = remainingChoices / boundaryDivisor;
+					remainingChoices %= boundaryDivisor;
+					boundaryDivisor /= 3;
+					//the boundary column between the strips on either side of this crossing
+					const int32 boundaryU = stripOffset > 0 ? (boundaryNum + 1) * f : -boundaryNum * f;
+					if (join == 1)
+					{
+						rotateStripUnfolding(unfolding, boundaryU, boundaryU + 2 * f, stripOffset > 0);
+					}
+					else if (join == 2)
+					{
+						rotateStripUnfolding(unfolding, boundaryU, boundaryU + f, stripOffset < 0);
+					}
+				}
+				bool isDuplicate = false;
+				for (int32 unfoldingNum = firstUnfolding; unfoldingNum < int32(stripUnfoldingsM.size()) && !isDuplicate; ++unfoldingNum)
+				{
+					isDuplicate = std::memcmp(&stripUnfoldingsM[unfoldingNum], &unfolding, sizeof(FStripUnfolding)) == 0;
+				}
+				if (!isDuplicate)
+				{
+					stripUnfoldingsM.push_back(unfolding);
+				}
+			}
+		}
+		stripUnfoldingOffsetsM.push_back(int32(stripUnfoldingsM.size()));
+	}
+
+	void FIcosahedralGrid::getUnfoldedGridPosition(const int32& tileIndex, int32& strip, int32& uPos, int32& vPos) const
+	{
+		const int32 f = gridFrequency;
+		const FGridIndex gridIndex = getPrimaryGridIndex(tileIndex);
+		//undo the phase shift of the column so the strips line up
+		uPos = gridIndex.uPos;
+		vPos = gridIndex.vPos + f * ((uPos + f - 1) / f);
+		if (uPos == 0)
+		{
+			uPos = 5 * f;
+			vPos += 5 * f;
+		}
+		strip = (uPos - 1) / f;
+		//the top of a boundary column is the left edge of the next strip's upper diamond
+		if (uPos % f == 0 && vPos > (uPos / f + 2) * f)
+		{
+			++strip;
+		}
+		//report the position as if its strip were strip 0
+		uPos -= strip * f;
+		vPos -= strip * f;
+		strip %= 5;
+	}
+
+	int32 FIcosahedralGrid::getGridDistance(const int32& tileA, const int32& tileB) const
+	{
+		int32 stripA, uA, vA;
+		int32 stripB, uB, vB;
+		getUnfoldedGridPosition(tileA, stripA, uA, vA);
+		getUnfoldedGridPosition(tileB, stripB, uB, vB);
+		const int32 f = gridFrequency;
+		//B's strip is reached going either way round the sphere
+		const int32 forwardOffset = (stripB - stripA + 5) % 5;
+		const int32 stripOffsets[2] = { forwardOffset, forwardOffset - 5 };
+		int32 gridDistance = std::numeric_limits<int32>::max();
+		for (const int32& stripOffset : stripOffsets)
+		{
+			if (std::abs(stripOffset) > MaxStripUnfoldingOffset)
+			{
+				continue;
+			}
+			const int32 uShifted = uB + stripOffset * f;
+			const int32 vShifted = vB + stripOffset * f;
+			const int32 tableNum = stripOffset + MaxStripUnfoldingOffset;
+			for (int32 unfoldingNum = stripUnfoldingOffsetsM[tableNum]; unfoldingNum < stripUnfoldingOffsetsM[tableNum + 1]; ++unfoldingNum)
+			{
+				const FStripUnfolding& unfolding = stripUnfoldingsM[unfoldingNum];
+				const int32 du = unfolding.uu * uShifted + unfolding.uv * vShifted + unfolding.uOffset - uA;
+				const int32 dv = unfolding.vu * uShifted + unfolding.vv * vShifted + unfolding.vOffset - vA;
+				gridDistance = std::min(gridDistance, axialGridDistance(du, dv));
+			}
+		}
+		return gridDistance;
+	}
+
+	float FIcosahedralGrid::getGreatCircleDistance(const int32& tileA, const int32& tileB) const
+	{
+		float greatCircleDistance;
+		getGreatCircleDistances(&tileA, &tileB, &greatCircleDistance, 1);
+		return greatCircleDistance;
+	}
+
+	void FIcosahedralGrid::getGreatCircleDistances(const int32* tilesA, const int32* tilesB, float* outDistances, int32 numPairs) const
+	{
+		const float* locationsX = tileLocationsXM.GetData();
+		const float* locationsY = tileLocationsYM.GetData();
+		const float* locationsZ = tileLocationsZM.GetData();
+		for (int32 pairNum = 0; pairNum < numPairs; ++pairNum)
+		{
+			const int32 tileA = tilesA[pairNum];
+			const int32 tileB = tilesB[pairNum];
+			outDistances[pairNum] = unitVectorAngle(locationsX[tileA], locationsY[tileA], locationsZ[tileA],
+				locationsX[tileB], locationsY[tileB], locationsZ[tileB]);
+		}
+	}
+
+	void FIcosahedralGrid::getGreatCircleDistancesFromTile(const int32& originTile, const int32* tileIndexes, float* outDistances, int32 numTiles) const
+	{
+		const float* locationsX = tileLocationsXM.GetData();
+		const float* locationsY = tileLocationsYM.GetData();
+		const float* locationsZ = tileLocationsZM.GetData();
+		const float originX = locationsX[originTile];
+		const float originY = locationsY[originTile];
+		const float originZ = locationsZ[originTile];
+		for (int32 tileNum = 0; tileNum < numTiles; ++tileNum)
+		{
+			const int32 tileIndex = tileIndexes[tileNum];
+			outDistances[tileNum] = unitVectorAngle(originX, originY, originZ, locationsX[tileIndex], locationsY[tileIndex], locationsZ[tileIndex]);
+		}
+	}
+
+	void FIcosahedralGrid::traceGreatCircleBetweenTiles(const int32& startTile, const int32& endTile, std::vector<int32>& outTileIndexes) const
+	{
+		outTileIndexes.clear();
+		outTileIndexes.push_back(startTile);
+		if (startTile == endTile)
+		{
+			return;
+		}
+		//the plane of the great circle
+		const FVector3f startLocation = getTileLocationOnSphere(startTile);
+		const FVector3f endLocation = getTileLocationOnSphere(endTile);
+		FVector3f arcNormal = FVector3f::crossProduct(startLocation, endLocation);
+		if (arcNormal.sizeSquared() < KindaSmallNumber * KindaSmallNumber)
+		{
+			//every great circle joins opposite tiles, take the one through the first neighbor
+			arcNormal = FVector3f::crossProduct(startLocation, getTileLocationOnSphere(getTileNeighborView(startTile)[0]));
+		}
+		arcNormal = arcNormal.getSafeNormal();
+
+		//step to whichever neighbor moves along the arc while staying closest to it, a neighbor is ahead when
+		//turning from the current tile to it goes the same way round arcNormal as the arc does, the walk only
+		//ever moves forward so it reaches the end tile within numNodes steps
+		int32 currentTile = startTile;
+		for (int32 stepNum = 0; currentTile != endTile && stepNum < numNodes; ++stepNum)
+		{
+			const FVector3f currentLocation = getTileLocationOnSphere(currentTile);
+			const FVector3f aheadDir = FVector3f::crossProduct(arcNormal, currentLocation);
+			int32 nextTile = IndexNone;
+			float nextArcOffset = std::numeric_limits<float>::max();
+			for (const int32& neighborIndex : getTileNeighborView(currentTile))
+			{
+				if (neighborIndex == endTile)
+				{
+					nextTile = endTile;
+					break;
+				}
+				const float neighborX = tileLocationsXM[neighborIndex];
+				const float neighborY = tileLocationsYM[neighborIndex];
+				const float neighborZ = tileLocationsZM[neighborIndex];
+				const float arcOffset = std::abs(neighborX * arcNormal.X + neighborY * arcNormal.Y + neighborZ * arcNormal.Z);
+				if (neighborX * aheadDir.X + neighborY * aheadDir.Y + neighborZ * aheadDir.Z > 0.0f && arcOffset < nextArcOffset)
+				{
+					nextTile = neighborIndex;
+					nextArcOffset = arcOffset;
+				}
+			}
+			HEXPLANET_CHECK_SLOW(nextTile != IndexNone);
+			outTileIndexes.push_back(nextTile);
+			currentTile = nextTile;
+		}
+	}
+
+	void FIcosahedralGrid::traceGreatCirclesBetweenTiles(const int32* startTiles, const int32* endTiles, int32 numPaths,
+		std::vector<int32>& outPathOffsets, std::vector<int32>& outPathTiles) const
+	{
+		std::vector<std::vector<int32>> paths(numPaths);
+		parallelFor(numPaths, [&](int32 pathNum)
+		{
+			traceGreatCircleBetweenTiles(startTiles[pathNum], endTiles[pathNum], paths[pathNum]);
+		});
+		outPathOffsets.resize(numPaths + 1);
+		outPathOffsets[0] = 0;
+		for (int32 pathNum = 0; pathNum < numPaths; ++pathNum)
+		{
+			outPathOffsets[pathNum + 1] = outPathOffsets[pathNum] + int32(paths[pathNum].size());
+		}
+		outPathTiles.resize(outPathOffsets[numPaths]);
+		for (int32 pathNum = 0; pathNum < numPaths; ++pathNum)
+		{
+			std::copy(paths[pathNum].begin(), paths[pathNum].end(), outPathTiles.begin() + outPathOffsets[pathNum]);
+		}
+	}
+}
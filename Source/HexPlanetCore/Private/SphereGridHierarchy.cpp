@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereGridHierarchy.h"
+
+namespace HexPlanet
+{
+	namespace
+	{
+		//column u is stored shifted down by f for every strip boundary before it, adding the shift back
+		//lines the strips up so the lattice is flat across each of them
+		HEXPLANET_FORCEINLINE int32 getUnwrappedV(const int32& gridFrequency, const int32& uLoc, const int32& vLoc)
+		{
+			return vLoc + gridFrequency * ((uLoc + gridFrequency - 1) / gridFrequency);
+		}
+
+		int32 getTileAtUnwrappedPosition(const FIcosahedralGrid& grid, int32 uPos, int32 vPos)
+		{
+			const int32 f = grid.gridFrequency;
+			//the last column wraps round onto column 0
+			if (uPos >= 5 * f)
+			{
+				uPos -= 5 * f;
+				vPos -= 5 * f;
+			}
+			return grid.getRectilinearTile(uPos, vPos - f * ((uPos + f - 1) / f));
+		}
+	}
+
+	FSphereGridLevelLink::FSphereGridLevelLink()
+		: refinementRatio(0), numCoarseTiles(0), numFineTiles(0)
+	{
+	}
+
+	bool FSphereGridLevelLink::build(const FIcosahedralGrid& coarseGrid, const FIcosahedralGrid& fineGrid)
+	{
+		const int32 coarseFrequency = coarseGrid.gridFrequency;
+		const int32 fineFrequency = fineGrid.gridFrequency;
+		if (fineFrequency != 2 * coarseFrequency && fineFrequency != 3 * coarseFrequency)
+		{
+			return false;
+		}
+		refinementRatio = fineFrequency / coarseFrequency;
+		numCoarseTiles = coarseGrid.numNodes;
+		numFineTiles = fineGrid.numNodes;
+
+		parentTiles.resize(3 * numFineTiles);
+		parentWeights.resize(3 * numFineTiles);
+		childTiles.assign(numCoarseTiles, IndexNone);
+		std::vector<int32> numRestrictionTiles(numCoarseTiles, 0);
+		const float weightScale = 1.0f / refinementRatio;
+		for (int32 fineTile = 0; fineTile < numFineTiles; ++fineTile)
+		{
+			//fine position (u, v) lies at (u / ratio, v / ratio) on the coarse lattice
+			const FGridIndex fineIndex = fineGrid.getPrimaryGridIndex(fineTile);
+			const int32 uFine = fineIndex.uPos;
+			const int32 vFine = getUnwrappedV(fineFrequency, fineIndex.uPos, fineIndex.vPos);
+			const int32 uBase = uFine / refinementRatio;
+			const int32 vBase = vFine / refinementRatio;
+			const int32 uRemainder = uFine % refinementRatio;
+			const int32 vRemainder = vFine % refinementRatio;
+
+			//the lattice cell splits into two triangles along its u = v diagonal
+			int32 cornerSteps[3][2];
+			int32 cornerWeights[3];
+			cornerSteps[0][0] = 0; cornerSteps[0][1] = 0;
+			cornerSteps[2][0] = 1; cornerSteps[2][1] = 1;
+			if (uRemainder >= vRemainder)
+			{
+				cornerSteps[1][0] = 1; cornerSteps[1][1] = 0;
+				cornerWeights[0] = refinementRatio - uRemainder;
+				cornerWeights[1] = uRemainder - vRemainder;
+				cornerWeights[2] = vRemainder;
+			}
+			else
+			{
+				cornerSteps[1][0] = 0; cornerSteps[1][1] = 1;
+				cornerWeights[0] = refinementRatio - vRemainder;
+				cornerWeights[1] = vRemainder - uRemainder;
+				cornerWeights[2] = uRemainder;
+			}
+
+			//the first corner always carries weight, the others are only looked up when they do
+			//since a corner without weight can sit off the end of its column
+			const int32 baseTile = getTileAtUnwrappedPosition(coarseGrid, uBase, vBase);
+			for (int32 cornerNum = 0; cornerNum < 3; ++cornerNum)
+			{
+				int32 parentTile = baseTile;
+				if (cornerNum > 0 && cornerWeights[cornerNum] > 0)
+				{
+					parentTile = getTileAtUnwrappedPosition(coarseGrid, uBase + cornerSteps[cornerNum][0], vBase + cornerSteps[cornerNum][1]);
+				}
+				parentTiles[3 * fineTile + cornerNum] = parentTile;
+				parentWeights[3 * fineTile + cornerNum] = cornerWeights[cornerNum] * weightScale;
+				if (cornerWeights[cornerNum] > 0)
+				{
+					++numRestrictionTiles[parentTile];
+				}
+			}
+			if (cornerWeights[0] == refinementRatio)
+			{
+				childTiles[baseTile] = fineTile;
+			}
+		}
+
+		//transpose the interpolation so restriction gathers into each coarse tile
+		restrictionOffsets.resize(numCoarseTiles + 1);
+		restrictionOffsets[0] = 0;
+		for (int32 coarseTile = 0; coarseTile < numCoarseTiles; ++coarseTile)
+		{
+			restrictionOffsets[coarseTile + 1] = restrictionOffsets[coarseTile] + numRestrictionTiles[coarseTile];
+		}
+		restrictionTiles.resize(restrictionOffsets[numCoarseTiles]);
+		restrictionWeights.resize(restrictionOffsets[numCoarseTiles]);
+		std::vector<int32> nextRestrictionSlot(restrictionOffsets.begin(), restrictionOffsets.begin() + numCoarseTiles);
+		for (int32 fineTile = 0; fineTile < numFineTiles; ++fineTile)
+		{
+			for (int32 parentNum = 0; parentNum < 3; ++parentNum)
+			{
+				const float parentWeight = parentWeights[3 * fineTile + parentNum];
+				if (parentWeight > 0.0f)
+				{
+					const int32 slot = nextRestrictionSlot[parentTiles[3 * fineTile + parentNum]]++;
+					restrictionTiles[slot] = fineTile;
+					restrictionWeights[slot] = parentWeight;
+				}
+			}
+		}
+		for (int32 coarseTile = 0; coarseTile < numCoarseTiles; ++coarseTile)
+		{
+			float totalWeight = 0.0f;
+			for (int32 slot = restrictionOffsets[coarseTile]; slot < restrictionOffsets[coarseTile + 1]; ++slot)
+			{
+				totalWeight += restrictionWeights[slot];
+			}
+			for (int32 slot = restrictionOffsets[coarseTile]; slot < restrictionOffsets[coarseTile + 1]; ++slot)
+			{
+				restrictionWeights[slot] /= totalWeight;
+			}
+		}
+		return true;
+	}
+
+	void FSphereGridLevelLink::prolongateValues(const std::vector<float>& coarseValues, std::vector<float>& outFineValues) const
+	{
+		HEXPLANET_CHECK(int32(coarseValues.size()) == numCoarseTiles);
+		outFineValues.resize(numFineTiles);
+		for (int32 fineTile = 0; fineTile < numFineTiles; ++fineTile)
+		{
+			const int32 firstParent = 3 * fineTile;
+			outFineValues[fineTile] = parentWeights[firstParent] * coarseValues[parentTiles[firstParent]]
+				+ parentWeights[firstParent + 1] * coarseValues[parentTiles[firstParent + 1]]
+				+ parentWeights[firstParent + 2] * coarseValues[parentTiles[firstParent + 2]];
+		}
+	}
+
+	void FSphereGridLevelLink::restrictValues(const std::vector<float>& fineValues, std::vector<float>& outCoarseValues) const
+	{
+		HEXPLANET_CHECK(int32(fineValues.size()) == numFineTiles);
+		outCoarseValues.resize(numCoarseTiles);
+		for (int32 coarseTile = 0; coarseTile < numCoarseTiles; ++coarseTile)
+		{
+			float coarseValue = 0.0f;
+			for (int32 slot = restrictionOffsets[coarseTile]; slot < restrictionOffsets[coarseTile + 1]; ++slot)
+			{
+				coarseValue += restrictionWeights[slot] * fineValues[restrictionTiles[slot]];
+			}
+			outCoarseValues[coarseTile] = coarseValue;
+		}
+	}
+}
@@ -0,0 +1,165 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereGridPartition.h"
+#include "HexPlanetParallel.h"
+#include <algorithm>
+#include <iterator>
+
+namespace HexPlanet
+{
+	namespace
+	{
+		void sortUnique(std::vector<int32>& values)
+		{
+			std::sort(values.begin(), values.end());
+			values.erase(std::unique(values.begin(), values.end()), values.end());
+		}
+
+		void flattenChunkLists(const std::vector<std::vector<int32>>& chunkLists, std::vector<int32>& outOffsets, std::vector<int32>& outValues)
+		{
+			outOffsets.assign(1, 0);
+			outValues.clear();
+			for (const std::vector<int32>& chunkList : chunkLists)
+			{
+				outValues.insert(outValues.end(), chunkList.begin(), chunkList.end());
+				outOffsets.push_back(int32(outValues.size()));
+			}
+		}
+	}
+
+	FSphereGridPartition::FSphereGridPartition()
+		: chunksPerDiamondSide(1), haloWidth(1), numChunks(0)
+	{
+	}
+
+	void FSphereGridPartition::build(const FIcosahedralGrid& grid, int32 inChunksPerDiamondSide, int32 inHaloWidth)
+	{
+		const int32 f = grid.gridFrequency;
+		chunksPerDiamondSide = clampValue(inChunksPerDiamondSide, 1, f);
+		haloWidth = std::max(inHaloWidth, 0);
+		const int32 chunksPerDiamond = chunksPerDiamondSide * chunksPerDiamondSide;
+		numChunks = FIcosahedralGrid::NumIcosahedronDiamonds * chunksPerDiamond;
+
+		//the lattice steps inside a diamond are the same local coordinates mapPosToTileIndex rounds to
+		tileChunks.assign(grid.numNodes, IndexNone);
+		for (int32 diamondIndex = 0; diamondIndex < FIcosahedralGrid::NumIcosahedronDiamonds; ++diamondIndex)
+		{
+			for (int32 uStep = 0; uStep < f; ++uStep)
+			{
+				const int32 chunkRow = (diamondIndex * chunksPerDiamondSide + uStep * chunksPerDiamondSide / f) * chunksPerDiamondSide;
+				for (int32 vStep = 0; vStep < f; ++vStep)
+				{
+					tileChunks[grid.getDiamondTile(diamondIndex, uStep, vStep)] = chunkRow + vStep * chunksPerDiamondSide / f;
+				}
+			}
+		}
+		//the poles join the lowest numbered chunk around them
+		for (const int32& pentagonTile : grid.pentagonTileIndexesM)
+		{
+			if (tileChunks[pentagonTile] == IndexNone)
+			{
+				int32 poleChunk = numChunks;
+				for (const int32& neighborTile : grid.getTileNeighborView(pentagonTile))
+				{
+					poleChunk = std::min(poleChunk, tileChunks[neighborTile]);
+				}
+				tileChunks[pentagonTile] = poleChunk;
+			}
+		}
+
+		//counting sort by chunk keeps every chunk's tiles in ascending order
+		chunkTileOffsets.assign(numChunks + 1, 0);
+		for (const int32& tileChunk : tileChunks)
+		{
+			HEXPLANET_CHECK_SLOW(tileChunk != IndexNone);
+			++chunkTileOffsets[tileChunk + 1];
+		}
+		for (int32 chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+		{
+			chunkTileOffsets[chunkIndex + 1] += chunkTileOffsets[chunkIndex];
+		}
+		chunkTiles.resize(grid.numNodes);
+		std::vector<int32> chunkFill(chunkTileOffsets.begin(), chunkTileOffsets.end() - 1);
+		for (int32 tileIndex = 0; tileIndex < grid.numNodes; ++tileIndex)
+		{
+			chunkTiles[chunkFill[tileChunks[tileIndex]]++] = tileIndex;
+		}
+
+		chunkRangeOffsets.assign(1, 0);
+		chunkTileRanges.clear();
+		for (int32 chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+		{
+			for (const int32& tileIndex : getChunkTiles(chunkIndex))
+			{
+				if (int32(chunkTileRanges.size()) > chunkRangeOffsets.back())
+				{
+					FTileRange& lastRange = chunkTileRanges.back();
+					if (lastRange.firstTile + lastRange.numTiles == tileIndex)
+					{
+						++lastRange.numTiles;
+						continue;
+					}
+				}
+				FTileRange newRange;
+				newRange.firstTile = tileIndex;
+				newRange.numTiles = 1;
+				chunkTileRanges.push_back(newRange);
+			}
+			chunkRangeOffsets.push_back(int32(chunkTileRanges.size()));
+		}
+
+		//the halos grow one ring at a time out of the chunk, the first ring also tells which chunks share a border
+		std::vector<std::vector<int32>> haloTiles(numChunks);
+		std::vector<std::vector<int32>> neighborChunks(numChunks);
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			std::vector<int32>& chunkHalo = haloTiles[chunkIndex];
+			std::vector<int32> ringTiles;
+			for (const int32& tileIndex : getChunkTiles(chunkIndex))
+			{
+				for (const int32& neighborTile : grid.getTileNeighborView(tileIndex))
+				{
+					if (tileChunks[neighborTile] != chunkIndex)
+					{
+						ringTiles.push_back(neighborTile);
+					}
+				}
+			}
+			sortUnique(ringTiles);
+			std::vector<int32>& chunkNeighborList = neighborChunks[chunkIndex];
+			for (const int32& ringTile : ringTiles)
+			{
+				chunkNeighborList.push_back(tileChunks[ringTile]);
+			}
+			sortUnique(chunkNeighborList);
+
+			std::vector<int32> nextRingTiles;
+			for (int32 ringNum = 0; ringNum < haloWidth && !ringTiles.empty(); ++ringNum)
+			{
+				std::vector<int32> grownHalo;
+				grownHalo.reserve(chunkHalo.size() + ringTiles.size());
+				std::merge(chunkHalo.begin(), chunkHalo.end(), ringTiles.begin(), ringTiles.end(), std::back_inserter(grownHalo));
+				chunkHalo.swap(grownHalo);
+				if (ringNum + 1 == haloWidth)
+				{
+					break;
+				}
+				nextRingTiles.clear();
+				for (const int32& ringTile : ringTiles)
+				{
+					for (const int32& neighborTile : grid.getTileNeighborView(ringTile))
+					{
+						if (tileChunks[neighborTile] != chunkIndex && !std::binary_search(chunkHalo.begin(), chunkHalo.end(), neighborTile))
+						{
+							nextRingTiles.push_back(neighborTile);
+						}
+					}
+				}
+				sortUnique(nextRingTiles);
+				ringTiles.swap(nextRingTiles);
+			}
+		});
+		flattenChunkLists(haloTiles, chunkHaloOffsets, chunkHaloTiles);
+		flattenChunkLists(neighborChunks, chunkNeighborOffsets, chunkNeighbors);
+	}
+}
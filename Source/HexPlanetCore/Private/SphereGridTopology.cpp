@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereGridTopology.h"
+#include "SphereGridTopologyCache.h"
+
+namespace HexPlanet
+{
+	FSphereGridTopology::FSphereGridTopology(int32 inGridFrequency, uint32 inLayoutFlags)
+		: gridFrequency(inGridFrequency), layoutFlags(inLayoutFlags), numNodes(2 + 10 * inGridFrequency * inGridFrequency),
+		maxNeighborAngle(0.0f)
+	{
+	}
+
+	FSphereGridTopology::~FSphereGridTopology()
+	{
+	}
+
+	bool FSphereGridTopology::loadCache(const std::string& cacheDirectory)
+	{
+		std::shared_ptr<FSphereGridTopologyCache> newCache = std::make_shared<FSphereGridTopologyCache>();
+		if (!newCache->open(FSphereGridTopologyCache::getCacheFilePath(cacheDirectory, gridFrequency, layoutFlags), gridFrequency, layoutFlags))
+		{
+			return false;
+		}
+
+		//check every section before any table starts viewing the file
+		const int32 numColumns = 5 * gridFrequency;
+		const int32* columnOffsets = nullptr;
+		const int32* gridTiles = nullptr;
+		const uint32* primaryPositions = nullptr;
+		const int32* seamTiles = nullptr;
+		const int32* seamOffsets = nullptr;
+		const uint32* seamTilePositions = nullptr;
+		const int64* neighborOffsets = nullptr;
+		const int32* neighbors = nullptr;
+		const float* locationsX = nullptr;
+		const float* locationsY = nullptr;
+		const float* locationsZ = nullptr;
+		const int32* referenceTiles = nullptr;
+		const float* referencePoints = nullptr;
+		int64 numColumnOffsets = 0, numGridTiles = 0, numPrimaryPositions = 0, numSeamTiles = 0, numSeamOffsets = 0, numSeamPositions = 0,
+			numNeighborOffsets = 0, numNeighbors = 0, numLocationsX = 0, numLocationsY = 0, numLocationsZ = 0, numReferenceTiles = 0, numReferencePoints = 0;
+		const FSphereGridTopologyCache& cache = *newCache;
+		if (!cache.getSection(ESphereGridTopologySection::RectilinearColumnOffsets, numColumns + 1, columnOffsets, numColumnOffsets)
+			|| !cache.getSection(ESphereGridTopologySection::RectilinearGrid, columnOffsets[numColumns], gridTiles, numGridTiles)
+			|| !cache.getSection(ESphereGridTopologySection::TilePrimaryPositions, numNodes, primaryPositions, numPrimaryPositions)
+			|| !cache.getSection(ESphereGridTopologySection::SeamTiles, IndexNone, seamTiles, numSeamTiles)
+			|| !cache.getSection(ESphereGridTopologySection::SeamPositionOffsets, numSeamTiles + 1, seamOffsets, numSeamOffsets)
+			|| !cache.getSection(ESphereGridTopologySection::SeamPositions, seamOffsets[numSeamTiles], seamTilePositions, numSeamPositions)
+			|| !cache.getSection(ESphereGridTopologySection::TileNeighborOffsets, numNodes + 1, neighborOffsets, numNeighborOffsets)
+			|| !cache.getSection(ESphereGridTopologySection::TileNeighbors, neighborOffsets[numNodes], neighbors, numNeighbors)
+			|| !cache.getSection(ESphereGridTopologySection::TileLocationsX, numNodes, locationsX, numLocationsX)
+			|| !cache.getSection(ESphereGridTopologySection::TileLocationsY, numNodes, locationsY, numLocationsY)
+			|| !cache.getSection(ESphereGridTopologySection::TileLocationsZ, numNodes, locationsZ, numLocationsZ)
+			|| !cache.getSection(ESphereGridTopologySection::ReferenceTiles, 12, referenceTiles, numReferenceTiles)
+			|| !cache.getSection(ESphereGridTopologySection::ReferencePoints, 3 * numReferenceTiles, referencePoints, numReferencePoints))
+		{
+			return false;
+		}
+
+		rectilinearColumnOffsets.view(columnOffsets, numColumnOffsets);
+		rectilinearGrid.view(gridTiles, numGridTiles);
+		tilePrimaryPositions.view(primaryPositions, numPrimaryPositions);
+		seamPositionOffsets.view(seamOffsets, numSeamOffsets);
+		seamPositions.view(seamTilePositions, numSeamPositions);
+		tileNeighborOffsets.view(neighborOffsets, numNeighborOffsets);
+		tileNeighbors.view(neighbors, numNeighbors);
+		tileLocationsX.view(locationsX, numLocationsX);
+		tileLocationsY.view(locationsY, numLocationsY);
+		tileLocationsZ.view(locationsZ, numLocationsZ);
+		//the two maps are small enough to simply rebuild
+		seamTileSlots.clear();
+		seamTileSlots.reserve(numSeamTiles);
+		for (int32 seamSlot = 0; seamSlot < numSeamTiles; ++seamSlot)
+		{
+			seamTileSlots.emplace(seamTiles[seamSlot], seamSlot);
+		}
+		gridReferencePoints.clear();
+		for (int32 referenceNum = 0; referenceNum < numReferenceTiles; ++referenceNum)
+		{
+			const float* referencePoint = referencePoints + 3 * referenceNum;
+			gridReferencePoints.emplace(referenceTiles[referenceNum], FVector3f(referencePoint[0], referencePoint[1], referencePoint[2]));
+		}
+		maxNeighborAngle = cache.getHeader().maxNeighborAngle;
+		topologyCache = newCache;
+		return true;
+	}
+
+	bool FSphereGridTopology::saveCache(const std::string& cacheDirectory) const
+	{
+		std::vector<int32> seamTiles(seamTileSlots.size());
+		for (const auto& seamTileSlot : seamTileSlots)
+		{
+			seamTiles[seamTileSlot.second] = seamTileSlot.first;
+		}
+		//the reference points go in tile order
+		std::vector<int32> referenceTiles;
+		std::vector<float> referencePoints;
+		for (const auto& referencePoint : gridReferencePoints)
+		{
+			referenceTiles.push_back(referencePoint.first);
+			referencePoints.push_back(referencePoint.second.X);
+			referencePoints.push_back(referencePoint.second.Y);
+			referencePoints.push_back(referencePoint.second.Z);
+		}
+
+		FSphereGridTopologyCacheWriter topologyWriter(gridFrequency, layoutFlags, numNodes, maxNeighborAngle);
+		topologyWriter.addSection(ESphereGridTopologySection::RectilinearColumnOffsets, rectilinearColumnOffsets.GetData(), rectilinearColumnOffsets.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::RectilinearGrid, rectilinearGrid.GetData(), rectilinearGrid.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::TilePrimaryPositions, tilePrimaryPositions.GetData(), tilePrimaryPositions.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::SeamTiles, seamTiles.data(), int32(seamTiles.size()));
+		topologyWriter.addSection(ESphereGridTopologySection::SeamPositionOffsets, seamPositionOffsets.GetData(), seamPositionOffsets.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::SeamPositions, seamPositions.GetData(), seamPositions.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::TileNeighborOffsets, tileNeighborOffsets.GetData(), tileNeighborOffsets.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::TileNeighbors, tileNeighbors.GetData(), tileNeighbors.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::TileLocationsX, tileLocationsX.GetData(), tileLocationsX.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::TileLocationsY, tileLocationsY.GetData(), tileLocationsY.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::TileLocationsZ, tileLocationsZ.GetData(), tileLocationsZ.Num());
+		topologyWriter.addSection(ESphereGridTopologySection::ReferenceTiles, referenceTiles.data(), int32(referenceTiles.size()));
+		topologyWriter.addSection(ESphereGridTopologySection::ReferencePoints, referencePoints.data(), int32(referencePoints.size()));
+		return topologyWriter.write(FSphereGridTopologyCache::getCacheFilePath(cacheDirectory, gridFrequency, layoutFlags));
+	}
+
+	std::shared_ptr<const FDiskStencilSet> FSphereGridTopology::findDiskStencilSet(const int32& radius) const
+	{
+		std::lock_guard<std::mutex> stencilLock(diskStencilLock);
+		auto sharedStencils = diskStencilSets.find(radius);
+		if (sharedStencils == diskStencilSets.end())
+		{
+			return std::shared_ptr<const FDiskStencilSet>();
+		}
+		return sharedStencils->second.lock();
+	}
+
+	std::shared_ptr<const FDiskStencilSet> FSphereGridTopology::shareDiskStencilSet(const std::shared_ptr<const FDiskStencilSet>& diskStencils)
+	{
+		std::lock_guard<std::mutex> stencilLock(diskStencilLock);
+		std::weak_ptr<const FDiskStencilSet>& sharedStencils = diskStencilSets[diskStencils->radius];
+		//two grids can build the same radius at once, the first one shared wins
+		std::shared_ptr<const FDiskStencilSet> existingStencils = sharedStencils.lock();
+		if (existingStencils)
+		{
+			return existingStencils;
+		}
+		sharedStencils = diskStencils;
+		return diskStencils;
+	}
+
+	std::shared_ptr<FSphereGridTopology> FSphereGridTopologyRegistry::findTopology(int32 gridFrequency, uint32 layoutFlags)
+	{
+		std::lock_guard<std::mutex> registryLock(getRegistryLock());
+		std::unordered_map<uint64, std::weak_ptr<FSphereGridTopology>>& topologies = getTopologies();
+		auto registeredTopology = topologies.find(getTopologyKey(gridFrequency, layoutFlags));
+		if (registeredTopology == topologies.end())
+		{
+			return std::shared_ptr<FSphereGridTopology>();
+		}
+		return registeredTopology->second.lock();
+	}
+
+	std::shared_ptr<FSphereGridTopology> FSphereGridTopologyRegistry::registerTopology(const std::shared_ptr<FSphereGridTopology>& topology)
+	{
+		std::lock_guard<std::mutex> registryLock(getRegistryLock());
+		std::unordered_map<uint64, std::weak_ptr<FSphereGridTopology>>& topologies = getTopologies();
+		//forget the topologies nobody holds any more while we're here
+		for (auto topologyIt = topologies.begin(); topologyIt != topologies.end();)
+		{
+			if (topologyIt->second.expired())
+			{
+				topologyIt = topologies.erase(topologyIt);
+			}
+			else
+			{
+				++topologyIt;
+			}
+		}
+		std::weak_ptr<FSphereGridTopology>& registeredTopology = topologies[getTopologyKey(topology->gridFrequency, topology->layoutFlags)];
+		std::shared_ptr<FSphereGridTopology> existingTopology = registeredTopology.lock();
+		if (existingTopology)
+		{
+			return existingTopology;
+		}
+		registeredTopology = topology;
+		return topology;
+	}
+
+	int32 FSphereGridTopologyRegistry::getNumTopologies()
+	{
+		std::lock_guard<std::mutex> registryLock(getRegistryLock());
+		int32 numTopologies = 0;
+		for (const auto& registeredTopology : getTopologies())
+		{
+			if (!registeredTopology.second.expired())
+			{
+				++numTopologies;
+			}
+		}
+		return numTopologies;
+	}
+
+	uint64 FSphereGridTopologyRegistry::getTopologyKey(int32 gridFrequency, uint32 layoutFlags)
+	{
+		return (uint64(layoutFlags) << 32) | uint32(gridFrequency);
+	}
+
+	std::unordered_map<uint64, std::weak_ptr<FSphereGridTopology>>& FSphereGridTopologyRegistry::getTopologies()
+	{
+		static std::unordered_map<uint64, std::weak_ptr<FSphereGridTopology>> topologies;
+		return topologies;
+	}
+
+	std::mutex& FSphereGridTopologyRegistry::getRegistryLock()
+	{
+		static std::mutex registryLock;
+		return registryLock;
+	}
+}
@@ -0,0 +1,334 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SphereGridTopologyCache.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define SPHEREGRID_MAPPED_FILES 1
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <direct.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#define SPHEREGRID_MAPPED_FILES 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace HexPlanet
+{
+	namespace
+	{
+#if defined(_WIN32)
+		//paths are handed around as UTF-8, the wide file functions need them as UTF-16
+		std::wstring toWidePath(const std::string& filePath)
+		{
+			const int numWideChars = MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, nullptr, 0);
+			std::wstring widePath(numWideChars > 0 ? numWideChars : 1, L'\0');
+			MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, &widePath[0], numWideChars);
+			widePath.resize(widePath.size() - 1);
+			return widePath;
+		}
+#endif
+
+		FILE* openFile(const std::string& filePath, bool forWriting)
+		{
+#if defined(_WIN32)
+			return _wfopen(toWidePath(filePath).c_str(), forWriting ? L"wb" : L"rb");
+#else
+			return std::fopen(filePath.c_str(), forWriting ? "wb" : "rb");
+#endif
+		}
+
+		//creates every missing directory along the path
+		void makeDirectoryTree(const std::string& directoryPath)
+		{
+			for (size_t separator = directoryPath.find_first_of("/\\", 1); ; separator = directoryPath.find_first_of("/\\", separator + 1))
+			{
+				const std::string parentPath = directoryPath.substr(0, separator);
+				if (!parentPath.empty() && parentPath.back() != ':')
+				{
+#if defined(_WIN32)
+					_wmkdir(toWidePath(parentPath).c_str());
+#elif SPHEREGRID_MAPPED_FILES
+					mkdir(parentPath.c_str(), 0755);
+#endif
+				}
+				if (separator == std::string::npos)
+				{
+					break;
+				}
+			}
+		}
+
+		bool replaceFile(const std::string& sourcePath, const std::string& destinationPath)
+		{
+#if defined(_WIN32)
+			return MoveFileExW(toWidePath(sourcePath).c_str(), toWidePath(destinationPath).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			return std::rename(sourcePath.c_str(), destinationPath.c_str()) == 0;
+#endif
+		}
+
+		void deleteFile(const std::string& filePath)
+		{
+#if defined(_WIN32)
+			_wremove(toWidePath(filePath).c_str());
+#else
+			std::remove(filePath.c_str());
+#endif
+		}
+
+		uint32 getCurrentProcessId()
+		{
+#if defined(_WIN32)
+			return uint32(GetCurrentProcessId());
+#elif SPHEREGRID_MAPPED_FILES
+			return uint32(getpid());
+#else
+			return 0;
+#endif
+		}
+
+		HEXPLANET_FORCEINLINE int64 alignOffset(int64 offset, int64 alignment)
+		{
+			return (offset + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	FSphereGridTopologyCache::FSphereGridTopologyCache()
+		: fileData(nullptr), fileSize(0), mappedView(nullptr)
+	{
+	}
+
+	FSphereGridTopologyCache::~FSphereGridTopologyCache()
+	{
+		close();
+	}
+
+	std::string FSphereGridTopologyCache::getCacheFilePath(const std::string& cacheDirectory, int32 gridFrequency, uint32 layoutFlags)
+	{
+		//the version isn't part of the name so a new version replaces the old file instead of piling up next to it
+		char fileName[64];
+		std::snprintf(fileName, sizeof(fileName), "SphereGrid_F%d_L%u.topology", int(gridFrequency), unsigned(layoutFlags));
+		if (cacheDirectory.empty())
+		{
+			return fileName;
+		}
+		const char lastChar = cacheDirectory.back();
+		return cacheDirectory + (lastChar == '/' || lastChar == '\\' ? "" : "/") + fileName;
+	}
+
+	bool FSphereGridTopologyCache::open(const std::string& filePath, int32 gridFrequency, uint32 layoutFlags)
+	{
+		close();
+		if (!mapFile(filePath))
+		{
+			FILE* fileReader = openFile(filePath, false);
+			if (fileReader == nullptr)
+			{
+				return false;
+			}
+			std::fseek(fileReader, 0, SEEK_END);
+			const long readSize = std::ftell(fileReader);
+			std::fseek(fileReader, 0, SEEK_SET);
+			bool readFile = readSize > 0;
+			if (readFile)
+			{
+				loadedFileData.resize(readSize);
+				readFile = std::fread(loadedFileData.data(), 1, readSize, fileReader) == size_t(readSize);
+			}
+			std::fclose(fileReader);
+			if (!readFile)
+			{
+				loadedFileData.clear();
+				return false;
+			}
+			fileData = loadedFileData.data();
+			fileSize = int64(loadedFileData.size());
+		}
+
+		//anything that doesn't match exactly is treated as stale and gets rebuilt
+		bool isValid = fileData != nullptr && fileSize >= int64(sizeof(FSphereGridTopologyHeader));
+		if (isValid)
+		{
+			const FSphereGridTopologyHeader& header = getHeader();
+			isValid = header.magic == FileMagic
+				&& header.version == FileVersion
+				&& header.gridFrequency == gridFrequency
+				&& header.layoutFlags == layoutFlags
+				&& header.numNodes == 2 + 10 * gridFrequency * gridFrequency
+				&& header.fileSize == fileSize;
+			for (int32 section = 0; isValid && section < ESphereGridTopologySection::Num; ++section)
+			{
+				const int64 sectionOffset = header.sectionOffsets[section];
+				const int64 sectionSize = header.sectionSizes[section];
+				isValid = sectionOffset >= int64(sizeof(FSphereGridTopologyHeader))
+					&& sectionOffset % SectionAlignment == 0
+					&& sectionSize >= 0
+					&& sectionSize <= fileSize - sectionOffset;
+			}
+		}
+		if (!isValid)
+		{
+			close();
+		}
+		return isValid;
+	}
+
+	void FSphereGridTopologyCache::close()
+	{
+		unmapFile();
+		loadedFileData.clear();
+		loadedFileData.shrink_to_fit();
+		fileData = nullptr;
+		fileSize = 0;
+	}
+
+	bool FSphereGridTopologyCache::mapFile(const std::string& filePath)
+	{
+#if SPHEREGRID_MAPPED_FILES
+		void* fileView = nullptr;
+		int64 viewSize = 0;
+#if defined(_WIN32)
+		HANDLE fileHandle = CreateFileW(toWidePath(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER fileSizeInfo;
+		if (GetFileSizeEx(fileHandle, &fileSizeInfo) && fileSizeInfo.QuadPart > 0)
+		{
+			HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mappingHandle != nullptr)
+			{
+				//the view keeps the mapping alive on its own
+				fileView = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+				viewSize = fileSizeInfo.QuadPart;
+				CloseHandle(mappingHandle);
+			}
+		}
+		CloseHandle(fileHandle);
+#else
+		const int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+		{
+			return false;
+		}
+		struct stat fileStats;
+		if (fstat(fileDescriptor, &fileStats) == 0 && fileStats.st_size > 0)
+		{
+			fileView = mmap(nullptr, fileStats.st_size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+			viewSize = fileStats.st_size;
+			if (fileView == MAP_FAILED)
+			{
+				fileView = nullptr;
+			}
+		}
+		::close(fileDescriptor);
+#endif
+		if (fileView == nullptr)
+		{
+			return false;
+		}
+		mappedView = fileView;
+		fileData = static_cast<const uint8*>(fileView);
+		fileSize = viewSize;
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void FSphereGridTopologyCache::unmapFile()
+	{
+#if SPHEREGRID_MAPPED_FILES
+		if (mappedView != nullptr)
+		{
+#if defined(_WIN32)
+			UnmapViewOfFile(mappedView);
+#else
+			munmap(mappedView, fileSize);
+#endif
+		}
+#endif
+		mappedView = nullptr;
+	}
+
+	FSphereGridTopologyCacheWriter::FSphereGridTopologyCacheWriter(int32 gridFrequency, uint32 layoutFlags, int32 numNodes, float maxNeighborAngle)
+	{
+		std::memset(&header, 0, sizeof(header));
+		header.magic = FSphereGridTopologyCache::FileMagic;
+		header.version = FSphereGridTopologyCache::FileVersion;
+		header.gridFrequency = gridFrequency;
+		header.layoutFlags = layoutFlags;
+		header.numNodes = numNodes;
+		header.maxNeighborAngle = maxNeighborAngle;
+		for (int32 section = 0; section < ESphereGridTopologySection::Num; ++section)
+		{
+			sectionData[section] = nullptr;
+		}
+	}
+
+	void FSphereGridTopologyCacheWriter::addSectionBytes(ESphereGridTopologySection::Type section, const void* sectionBytes, int64 sectionSize)
+	{
+		sectionData[section] = sectionBytes;
+		header.sectionSizes[section] = sectionSize;
+	}
+
+	bool FSphereGridTopologyCacheWriter::write(const std::string& filePath)
+	{
+		const int64 sectionAlignment = FSphereGridTopologyCache::SectionAlignment;
+		int64 fileOffset = alignOffset(int64(sizeof(header)), sectionAlignment);
+		for (int32 section = 0; section < ESphereGridTopologySection::Num; ++section)
+		{
+			header.sectionOffsets[section] = fileOffset;
+			fileOffset = alignOffset(fileOffset + header.sectionSizes[section], sectionAlignment);
+		}
+		header.fileSize = fileOffset;
+
+		const size_t directoryEnd = filePath.find_last_of("/\\");
+		if (directoryEnd != std::string::npos)
+		{
+			makeDirectoryTree(filePath.substr(0, directoryEnd));
+		}
+		//every process writes its own temporary file, the last one moved into place wins
+		const std::string tempFilePath = filePath + "." + std::to_string(getCurrentProcessId()) + ".tmp";
+		FILE* fileWriter = openFile(tempFilePath, true);
+		if (fileWriter == nullptr)
+		{
+			return false;
+		}
+		uint8 padding[FSphereGridTopologyCache::SectionAlignment];
+		std::memset(padding, 0, sizeof(padding));
+		bool wroteFile = std::fwrite(&header, sizeof(header), 1, fileWriter) == 1;
+		wroteFile = wroteFile && std::fwrite(padding, 1, size_t(header.sectionOffsets[0] - sizeof(header)), fileWriter) == size_t(header.sectionOffsets[0] - sizeof(header));
+		for (int32 section = 0; wroteFile && section < ESphereGridTopologySection::Num; ++section)
+		{
+			const int64 sectionSize = header.sectionSizes[section];
+			if (sectionSize > 0)
+			{
+				wroteFile = std::fwrite(sectionData[section], 1, size_t(sectionSize), fileWriter) == size_t(sectionSize);
+			}
+			const int64 sectionEnd = header.sectionOffsets[section] + sectionSize;
+			const int64 nextOffset = section + 1 < ESphereGridTopologySection::Num ? header.sectionOffsets[section + 1] : header.fileSize;
+			wroteFile = wroteFile && std::fwrite(padding, 1, size_t(nextOffset - sectionEnd), fileWriter) == size_t(nextOffset - sectionEnd);
+		}
+		wroteFile = std::fclose(fileWriter) == 0 && wroteFile;
+
+		if (!wroteFile || !replaceFile(tempFilePath, filePath))
+		{
+			deleteFile(tempFilePath);
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,988 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TectonicSimulation.h"
+#include "HexPlanetParallel.h"
+#include "HexPlanetSIMD.h"
+#include <algorithm>
+#include <limits>
+
+namespace HexPlanet
+{
+	static const float SEA_LEVEL = 1.0;
+
+	FTectonicSimulationSettings::FTectonicSimulationSettings()
+		: heightMapSeed(0), numOctaves(1), percentOcean(60), percentContinentalCrust(65),
+		oceanicCrustRoughnessFactor(0.4f), continentalCrustFactorRoughness(0.5f), baseContinentalHeight(0.95f),
+		plateSeed(0), numBasePlates(12), numBaseSubplates(4), addSubplatesAfterNSteps(6),
+		percentTilesForShapeReseed(0.05f), percentTilesForBorderReseed(0.75f), stopAfterFirstPlate(false),
+		lithosphereDensity(3.4f), oceanicCrustDensity(3.0f), continentalCrustDensity(2.6f), oceanicWaterDensity(1.025f),
+		plateDirectionSeed(0), maxErrosionAmount(0.1f), errosionHeightCutoff(95), radiusAboutCollisionCellToDistributeCrust(5),
+		foldingRatio(0.0f)
+	{
+	}
+
+	FTectonicSimulation::FTectonicSimulation()
+		: simulationTimeStep(0), gridM(nullptr), planetRadiusM(0.0f)
+	{
+	}
+
+	void FTectonicSimulation::setPlanet(const FIcosahedralGrid* inGrid, float inPlanetRadius)
+	{
+		gridM = inGrid;
+		planetRadiusM = inPlanetRadius;
+	}
+
+	void FTectonicSimulation::generateInitialHeightMap(std::vector<bool>* outContinentalCells /*= nullptr*/)
+	{
+		//use 3d simplex noise to generate a continuous random starting height map
+		//for our sphere
+		std::vector<float> initialHeightMap(gridM->numNodes, 0.0f);
+		noiseM.setNoiseSeed(settings.heightMapSeed);
+		for (int32 nodeIndex = 0; nodeIndex < gridM->numNodes;++nodeIndex)
+		{
+			FVector3f nodeLocation = gridM->getTileLocationOnSphere(nodeIndex);
+			float magReduction = 1;
+			for (int32 octave = 0; octave < settings.numOctaves;++octave)
+			{
+				initialHeightMap[nodeIndex] += noiseM.simplexNoise3D(nodeLocation.X, nodeLocation.Y, nodeLocation.Z)/magReduction;
+				nodeLocation *= 2;
+				magReduction *= 2;
+			}
+		}
+
+		//create a distribution of the height map in order to separate between oceanic crust and
+		//continental crust
+		std::vector<float> heightToSort(initialHeightMap);
+		std::sort(heightToSort.begin(), heightToSort.end());
+		const int32 numHeights = int32(heightToSort.size());
+		int32 oceanDepthIndex = int32(std::floor(numHeights*settings.percentOcean / 100.0));
+		int32 continentalCrustIndex = int32(std::floor(numHeights*(100.0-settings.percentContinentalCrust) / 100.0));
+		float minHeight = heightToSort[0];
+		float baseOceanDepth = heightToSort[oceanDepthIndex] - minHeight; //use this as the normalization factor so that seaLevel == 1
+		float& baseContinentalHeight = settings.baseContinentalHeight;
+		baseContinentalHeight = (heightToSort[continentalCrustIndex]-minHeight)/baseOceanDepth;
+		if (outContinentalCells != nullptr)
+		{
+			outContinentalCells->assign(gridM->numNodes, false);
+		}
+		crustCells.resize(gridM->numNodes);
+		//normalize and separate into oceanic crust and continental crust
+		for (int32 nodeIndex = 0; nodeIndex < gridM->numNodes; ++nodeIndex)
+		{
+			initialHeightMap[nodeIndex] -= minHeight;
+			initialHeightMap[nodeIndex] /= baseOceanDepth;
+			if (initialHeightMap[nodeIndex] >= baseContinentalHeight)
+			{
+				initialHeightMap[nodeIndex] = SEA_LEVEL + (initialHeightMap[nodeIndex] - SEA_LEVEL)*settings.continentalCrustFactorRoughness;
+				if (outContinentalCells != nullptr)
+				{
+					(*outContinentalCells)[nodeIndex] = true;
+				}
+			}
+			else
+			{
+				initialHeightMap[nodeIndex] -= baseContinentalHeight / 2.0; //center the oceanic crust about a 0 height
+				initialHeightMap[nodeIndex] *= settings.oceanicCrustRoughnessFactor; //scale it by the roughness factor
+				initialHeightMap[nodeIndex] += (baseContinentalHeight / 2.0) * settings.oceanicCrustRoughnessFactor ; //re-baseline it so that the minimum value is 0.0
+			}
+			crustCells.setCell(nodeIndex, createBaseCrustCell(nodeIndex, initialHeightMap[nodeIndex]));
+		}
+		baseContinentalHeight = SEA_LEVEL - (SEA_LEVEL - baseContinentalHeight)*settings.continentalCrustFactorRoughness;
+	}
+
+	FCrustCell FTectonicSimulation::createBaseCrustCell(const int32& cellIndex, const float& cellHeight) const
+	{
+		//water height is 1.0;
+		FCrustCell newCellData;
+		newCellData.tileIndex = cellIndex;
+		newCellData.cellHeight = cellHeight;
+		newCellData.owningPlate = -1;
+		newCellData.cellTimeStamp = simulationTimeStep;
+		//get the exact area of the tile's cell
+		newCellData.crustArea = gridM->getTileCellArea(cellIndex)*std::pow(planetRadiusM, 2.0f);
+
+		if (cellHeight < SEA_LEVEL)
+		{
+			float lowerThickness = ((SEA_LEVEL - cellHeight)*settings.oceanicWaterDensity + cellHeight*settings.oceanicCrustDensity)
+				/ (settings.lithosphereDensity - settings.oceanicCrustDensity);
+			newCellData.crustThickness = cellHeight + lowerThickness;
+			newCellData.crustDensity = settings.oceanicCrustDensity;
+		}
+		else
+		{
+			float lowerThickness = cellHeight*settings.continentalCrustDensity / (settings.lithosphereDensity - settings.continentalCrustDensity);
+			newCellData.crustThickness = cellHeight + lowerThickness;
+			newCellData.crustDensity = settings.continentalCrustDensity;
+		}
+		return newCellData;
+	}
+
+	void FTectonicSimulation::buildTectonicPlates()
+	{
+		std::vector<std::vector<int32>> currentPlateSets;
+		std::vector<bool> usedTiles(gridM->numNodes, true);
+		plateRandomM.initialize(settings.plateSeed);
+		addNewSeedSetsToSetArray(usedTiles, currentPlateSets, settings.numBasePlates);
+		createVoronoiDiagramFromSeedSets(currentPlateSets, usedTiles, settings.addSubplatesAfterNSteps);
+		addNewSeedSetsToSetArray(usedTiles, currentPlateSets, settings.numBaseSubplates);
+		createVoronoiDiagramFromSeedSets(currentPlateSets, usedTiles);
+
+		// rebuild the plates from a random set of seed tiles inside of the plate
+		// to adjust the overall shape of the plate
+		rebuildTectonicPlates(currentPlateSets, settings.percentTilesForShapeReseed);
+		// rebuild the plates from a random set of seed tiles inside of the plate
+		// to adjust the shape of plate borders
+		rebuildTectonicPlates(currentPlateSets, settings.percentTilesForBorderReseed);
+
+		currentPlates.clear();
+		currentPlates.resize(currentPlateSets.size());
+		for (int32 plateIndex = 0; plateIndex < int32(currentPlateSets.size());++plateIndex)
+		{
+			currentPlates[plateIndex] = createTectonicPlate(plateIndex, currentPlateSets[plateIndex]);
+			if (settings.stopAfterFirstPlate)
+			{
+				break;
+			}
+		}
+	}
+
+	void FTectonicSimulation::addNewSeedSetsToSetArray(std::vector<bool> &usedTiles, std::vector<std::vector<int32>> &plateSets, const int32& numNewSets)
+	{
+		for (int it = 0; it < numNewSets; ++it)
+		{
+			int32 seedTile;
+			seedTile = getNextAvailableSeedTile(usedTiles, plateSets);
+			if (seedTile != -1)
+			{
+				usedTiles[seedTile] = false;
+				plateSets.push_back(std::vector<int32>(1, seedTile));
+			}
+			else
+			{
+				break;
+			}
+		}
+	}
+
+	int32 FTectonicSimulation::getNextAvailableSeedTile(std::vector<bool> &usedTiles, std::vector<std::vector<int32>> & plateSets)
+	{
+		bool success = false;
+		int32 seedTile;
+		while (!success)
+		{
+			seedTile = plateRandomM.randRange(0, gridM->numNodes - 1);
+			if (usedTiles[seedTile])
+			{
+				return seedTile;
+			}
+			else
+			{
+				int32 numUsedTiles = 0;
+				for (const std::vector<int32>& existingSet : plateSets)
+				{
+					numUsedTiles += int32(existingSet.size());
+				}
+				if (numUsedTiles >= gridM->numNodes)
+				{
+					break;
+				}
+			}
+		}
+		return -1;
+	}
+
+	void FTectonicSimulation::createVoronoiDiagramFromSeedSets(std::vector<std::vector<int32>>& seedSets,
+		std::vector<bool>& tileAvailability, const int32& maxNumIterations /*= -1*/) const
+	{
+		//produce our voronoi diagram using Manhattan distances
+		int32 currentIt = 0;
+		bool tryAgain = true;
+		while (tryAgain)
+		{
+			tryAgain = false;
+			for (std::vector<int32>& tileSet : seedSets)
+			{
+				size_t startNumTiles = tileSet.size();
+				gridM->expandTileSet(tileSet, tileAvailability);
+				tryAgain |= startNumTiles < tileSet.size();
+			}
+			if (maxNumIterations == currentIt)
+			{
+				break;
+			}
+			currentIt++;
+		}
+	}
+
+	void FTectonicSimulation::rebuildTectonicPlates(std::vector<std::vector<int32>>& plateSets, const float& percentTilesForReseed)
+	{
+		std::vector<bool> usedTiles(gridM->numNodes, true);
+		for (std::vector<int32>& tileSet : plateSets)
+		{
+			int32 numSubSeeds = roundToInt(tileSet.size() * percentTilesForReseed) + 1;
+			std::vector<int32> subSeedNums;
+			for (int32 subseedNum = 0; subseedNum < numSubSeeds; ++subseedNum)
+			{
+				int32 newSubSeed = plateRandomM.randRange(0, int32(tileSet.size()) - 1);
+				subSeedNums.push_back(tileSet[newSubSeed]);
+			}
+			tileSet.clear();
+			for (const int32& subSeed : subSeedNums)
+			{
+				tileSet.push_back(subSeed);
+				usedTiles[subSeed] = false;
+			}
+		}
+		createVoronoiDiagramFromSeedSets(plateSets,usedTiles);
+	}
+
+	FTectonicPlate FTectonicSimulation::createTectonicPlate(const int32& plateIndex, const std::vector<int32>& plateCellIndexes)
+	{
+		FTectonicPlate newPlate;
+		newPlate.plateIndex = plateIndex;
+		newPlate.currentVelocity = FVector3f(0, 0, 0);
+		newPlate.ownedCrustCells.reserve(plateCellIndexes.size());
+		for (const int32& ownedCell : plateCellIndexes)
+		{
+			crustCells.owningPlates[ownedCell] = newPlate.plateIndex;
+			newPlate.ownedCrustCells.push_back(ownedCell);
+		}
+		updatePlateCenterOfMass(newPlate);
+		updatePlateBoundingRadius(newPlate);
+		return newPlate;
+	}
+
+	FVector3f FTectonicSimulation::computePlateCenterOfMass(const FTectonicPlate& plate, float& outTotalMass) const
+	{
+		FVector3f massMomentArm(0, 0, 0);
+		float totalMass = 0.0;
+		for (const int32& plateCellIndex : plate.ownedCrustCells)
+		{
+			const float crustThickness = crustCells.crustThicknesses[plateCellIndex];
+			float cellMass = crustThickness*crustCells.crustAreas[plateCellIndex]*crustCells.crustDensities[plateCellIndex];
+			totalMass += cellMass;
+			massMomentArm += cellMass * gridM->getTileLocationOnSphere(crustCells.tileIndexes[plateCellIndex])
+				*(planetRadiusM + crustCells.cellHeights[plateCellIndex] - crustThickness / 2);
+		}
+		outTotalMass = totalMass;
+		return massMomentArm / totalMass;
+	}
+
+	void FTectonicSimulation::updatePlateCenterOfMass(FTectonicPlate &newPlate) const
+	{
+		if (newPlate.ownedCrustCells.size()==0)
+		{
+			newPlate.centerOfMassIndex = -1;
+		}
+		else
+		{
+			FVector3f centerOfMass = computePlateCenterOfMass(newPlate, newPlate.plateTotalMass);
+			newPlate.centerOfMassIndex = gridM->mapPosToTileIndex(centerOfMass);
+		}
+	}
+
+	void FTectonicSimulation::updatePlateBoundingRadius(FTectonicPlate& newPlate) const
+	{
+		//acos is decreasing, so the farthest cell is the one with the smallest dot product and only it needs an acos
+		FVector3f plateCenterDir = gridM->getTileLocationOnSphere(newPlate.centerOfMassIndex);
+		float minCellDot = 1.0f;
+		for (const int32& plateCellIndex : newPlate.ownedCrustCells)
+		{
+			FVector3f cellCenter = gridM->getTileLocationOnSphere(crustCells.tileIndexes[plateCellIndex]);
+			minCellDot = std::min(minCellDot, FVector3f::dotProduct(plateCenterDir, cellCenter));
+		}
+		newPlate.plateBoundingRadius = std::max(acosClamped(minCellDot), newPlate.plateBoundingRadius);
+	}
+
+	bool FTectonicSimulation::mightPlatesOverlap(const int32& plateA, const int32& plateB) const
+	{
+		const FTectonicPlate& firstPlate = currentPlates[plateA];
+		const FTectonicPlate& secondPlate = currentPlates[plateB];
+		if (firstPlate.centerOfMassIndex == IndexNone || secondPlate.centerOfMassIndex == IndexNone)
+		{
+			return false;
+		}
+		return gridM->getGreatCircleDistance(firstPlate.centerOfMassIndex, secondPlate.centerOfMassIndex)
+			<= firstPlate.plateBoundingRadius + secondPlate.plateBoundingRadius;
+	}
+
+	void FTectonicSimulation::initializePlateDirections()
+	{
+		plateRandomM.initialize(settings.plateDirectionSeed);
+		for (FTectonicPlate& tecPlate : currentPlates)
+		{
+			FVector3f dirVector(plateRandomM.fRandRange(-Pi, Pi), plateRandomM.fRandRange(-Pi, Pi), 0);
+			dirVector /= std::sqrt(FVector3f::dotProduct(dirVector, dirVector));
+			// set the initial velocity to be roughly one tile per step
+			dirVector *= plateRandomM.fRandRange(0, (Pi - acosClamped(float(std::sqrt(5.0f)/3.0)))/gridM->gridFrequency);
+			tecPlate.currentVelocity = dirVector;
+		}
+	}
+
+	int32 FTectonicSimulation::computeErosionInflows(const float& cellHeight, const float* neighborHeights, const int32& numNeighbors,
+		float* outInflows) const
+	{
+		//for the moment we're going to simply apply a smoothing algorithm to mimic
+		//the effects of erosion, once we have a system for weather calculation
+		//we can use that to drive the erosion process
+		std::fill(outInflows, outInflows + numNeighbors, 0.0f);
+		if (cellHeight < settings.errosionHeightCutoff * SEA_LEVEL / 100.0)//the base continental crust height level value
+		{
+			return 0;
+		}
+
+		//find the lower neighbors
+		int32 lowerNeighbors[FIcosahedralGrid::MaxTileNeighbors];
+		int32 numLowerNeighbors = 0;
+		for (int32 neighborNum = 0; neighborNum < numNeighbors; ++neighborNum)
+		{
+			if (neighborHeights[neighborNum] < cellHeight)
+			{
+				lowerNeighbors[numLowerNeighbors++] = neighborNum;
+			}
+		}
+		if (numLowerNeighbors == 0)
+		{
+			//we're the lowest point around, therefore we're done here
+			return 0;
+		}
+		//sort in descending order, neighbors of equal height keep their ring order so the result never depends on the sort
+		std::stable_sort(lowerNeighbors, lowerNeighbors + numLowerNeighbors, [&](const int32& neighbor1, const int32& neighbor2)->bool
+		{
+			return neighborHeights[neighbor1] > neighborHeights[neighbor2];
+		});
+
+		//find note the minimum height difference between this cell and its lower neighbors
+		//this represents the volume of material that would need to be removed to make the cell
+		//the same height as its next tallest neighbor
+		float minHeightDifference = cellHeight - neighborHeights[lowerNeighbors[0]];
+		//setting a maxErrosion amount allows for us to keep jagged cliffs for a time
+		if (minHeightDifference > SEA_LEVEL*settings.maxErrosionAmount / 100.0)
+		{
+			minHeightDifference = SEA_LEVEL*settings.maxErrosionAmount / 100.0;
+		}
+
+		//find the sum of the height differences between the cell's next tallest neighbor and the rest
+		//of its shorter neighbors. This represents the capacity of its neighbors to receive material
+		//without growing taller than the next tallest neighbor
+		float baseNeighborCapacity = 0.0;
+		for (int32 lowerNum = 0; lowerNum < numLowerNeighbors; ++lowerNum)
+		{
+			baseNeighborCapacity += cellHeight - minHeightDifference - neighborHeights[lowerNeighbors[lowerNum]];
+		}
+
+		//two options, first the neighboring cells have enough capacity to receive all of the material to be removed
+		// or they don't. If they don't reduce the minHeightDifference to their total capacity
+		if (baseNeighborCapacity < minHeightDifference)
+		{
+			minHeightDifference = baseNeighborCapacity;
+		}
+
+		//now spread that total material about the lower neighbors
+		const float erodedCellHeight = cellHeight - minHeightDifference;
+		float grownHeights[FIcosahedralGrid::MaxTileNeighbors];
+		std::copy(neighborHeights, neighborHeights + numNeighbors, grownHeights);
+		int32 numOpenNeighbors = numLowerNeighbors;
+		while (minHeightDifference > 0 && numOpenNeighbors > 0)
+		{
+			int32 numStillOpen = 0;
+			for (int32 openNum = 0; openNum < numOpenNeighbors; ++openNum)
+			{
+				const int32 neighborNum = lowerNeighbors[openNum];
+				float amountToAdd = minHeightDifference / (numOpenNeighbors - openNum);
+				// increase the neighbor to a maximum of the cell's new height
+				if (erodedCellHeight <= grownHeights[neighborNum])
+				{
+					//this index is done
+					continue;
+				}
+				else if (erodedCellHeight >= grownHeights[neighborNum] + amountToAdd)
+				{
+					grownHeights[neighborNum] += amountToAdd;
+					outInflows[neighborNum] += amountToAdd;
+					minHeightDifference -= amountToAdd;
+					lowerNeighbors[numStillOpen++] = neighborNum;
+				}
+				else
+				{
+					minHeightDifference -= erodedCellHeight - grownHeights[neighborNum];
+					outInflows[neighborNum] += erodedCellHeight - grownHeights[neighborNum];
+					grownHeights[neighborNum] = erodedCellHeight;
+					//this index is done
+				}
+			}
+			numOpenNeighbors = numStillOpen;
+		}
+		return numLowerNeighbors;
+	}
+
+	void FTectonicSimulation::erodeCell(FCrustCell& targetCell)
+	{
+		const FTileIndexView cellNeighbors = gridM->getTileNeighborView(targetCell.tileIndex);
+		const int32 numNeighbors = int32(cellNeighbors.Num());
+		float neighborHeights[FIcosahedralGrid::MaxTileNeighbors] = {};
+		for (int32 neighborNum = 0; neighborNum < numNeighbors; ++neighborNum)
+		{
+			neighborHeights[neighborNum] = crustCells.cellHeights[cellNeighbors[neighborNum]];
+		}
+		float neighborInflows[FIcosahedralGrid::MaxTileNeighbors];
+		if (computeErosionInflows(targetCell.cellHeight, neighborHeights, numNeighbors, neighborInflows) == 0)
+		{
+			return;
+		}
+		int32 lowerNeighbors[FIcosahedralGrid::MaxTileNeighbors];
+		int32 numLowerNeighbors = 0;
+		for (int32 neighborNum = 0; neighborNum < numNeighbors; ++neighborNum)
+		{
+			if (neighborHeights[neighborNum] < targetCell.cellHeight)
+			{
+				const int32 neighborIndex = cellNeighbors[neighborNum];
+				crustCells.crustThicknesses[neighborIndex] += neighborInflows[neighborNum];
+				lowerNeighbors[numLowerNeighbors++] = neighborIndex;
+			}
+		}
+		relevelCrustCells(lowerNeighbors, numLowerNeighbors);
+		updateCrustCellHeight(targetCell);
+	}
+
+	void FTectonicSimulation::erodeCells()
+	{
+		//every cell works out what it sheds onto its lower neighbors from the heights before the pass, then every
+		//cell gathers what its neighbors shed onto it, so no cell is written by two threads and the order the
+		//cells are handed out in never changes the result
+		const int32 numCrustCells = crustCells.num();
+		erosionHeightsM = crustCells.cellHeights;
+		erosionInflowsM.resize(size_t(numCrustCells) * FIcosahedralGrid::MaxTileNeighbors);
+		erodedCellsM.resize(numCrustCells);
+
+		const int32 CellsPerChunk = 4096;
+		const int32 numChunks = (numCrustCells + CellsPerChunk - 1) / CellsPerChunk;
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			float neighborHeights[FIcosahedralGrid::MaxTileNeighbors];
+			const int32 chunkEnd = std::min(numCrustCells, (chunkIndex + 1)*CellsPerChunk);
+			for (int32 cellIndex = chunkIndex*CellsPerChunk; cellIndex < chunkEnd; ++cellIndex)
+			{
+				const FTileIndexView cellNeighbors = gridM->getTileNeighborView(cellIndex);
+				for (int32 neighborNum = 0; neighborNum < cellNeighbors.Num(); ++neighborNum)
+				{
+					neighborHeights[neighborNum] = erosionHeightsM[cellNeighbors[neighborNum]];
+				}
+				computeErosionInflows(erosionHeightsM[cellIndex], neighborHeights, int32(cellNeighbors.Num()),
+					erosionInflowsM.data() + size_t(cellIndex) * FIcosahedralGrid::MaxTileNeighbors);
+			}
+		});
+
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			const float erosionCutoff = settings.errosionHeightCutoff * SEA_LEVEL / 100.0;
+			const int32 chunkStart = chunkIndex*CellsPerChunk;
+			const int32 chunkEnd = std::min(numCrustCells, chunkStart + CellsPerChunk);
+			int32 numErodedCells = 0;
+			for (int32 cellIndex = chunkStart; cellIndex < chunkEnd; ++cellIndex)
+			{
+				const float cellHeight = erosionHeightsM[cellIndex];
+				//a cell is releveled when it erodes or when a neighbor erodes onto it, like erodeCell does
+				bool relevelCell = false;
+				float cellInflow = 0.0f;
+				for (const int32& neighborIndex : gridM->getTileNeighborView(cellIndex))
+				{
+					const float neighborHeight = erosionHeightsM[neighborIndex];
+					if (neighborHeight < cellHeight)
+					{
+						relevelCell |= cellHeight >= erosionCutoff;
+					}
+					else if (cellHeight < neighborHeight && neighborHeight >= erosionCutoff)
+					{
+						const FTileIndexView neighborRing = gridM->getTileNeighborView(neighborIndex);
+						const int32 ringNum = int32(std::find(neighborRing.begin(), neighborRing.end(), cellIndex) - neighborRing.begin());
+						cellInflow += erosionInflowsM[size_t(neighborIndex) * FIcosahedralGrid::MaxTileNeighbors + ringNum];
+						relevelCell = true;
+					}
+				}
+				if (relevelCell)
+				{
+					crustCells.crustThicknesses[cellIndex] += cellInflow;
+					erodedCellsM[chunkStart + numErodedCells++] = cellIndex;
+				}
+			}
+			//the chunk's own heights aren't read by the other chunks in this pass, the sea level test still sees the height before the pass
+			relevelCrustCells(erodedCellsM.data() + chunkStart, numErodedCells);
+		});
+	}
+
+	void FTectonicSimulation::updateCrustCellHeight(FCrustCell& crustCell) const
+	{
+		crustCell.cellHeight = computeCellHeight(crustCell.cellHeight, crustCell.crustThickness, crustCell.crustDensity);
+	}
+
+	/*! The parts of the isostasy equations that only depend on the settings*/
+	struct FIsostasyTerms
+	{
+		explicit FIsostasyTerms(const FTectonicSimulationSettings& settings)
+			: lithosphereDensity(settings.lithosphereDensity), seaLevelWaterMass(SEA_LEVEL*settings.oceanicWaterDensity),
+			waterDisplacedDensity(settings.lithosphereDensity - settings.oceanicWaterDensity)
+		{
+		}
+
+		float lithosphereDensity;
+		float seaLevelWaterMass;
+		float waterDisplacedDensity;
+	};
+
+	/*!
+	* Both the land and the ocean heights are worked out and the sea level test picks one, the
+	* lanes of relevelCellBlock do the same operations in the same order
+	*/
+	static HEXPLANET_FORCEINLINE float computeIsostaticHeight(const FIsostasyTerms& terms, const float& cellHeight, const float& crustThickness, const float& crustDensity)
+	{
+		//above water the crust floats on the lithosphere alone
+		const float cellDraft = crustThickness*crustDensity / terms.lithosphereDensity;
+		const float landHeight = crustThickness - cellDraft;
+		//under water the ocean above it presses it down as well
+		const float oceanHeight = (crustThickness*(terms.lithosphereDensity - crustDensity) - terms.seaLevelWaterMass) / terms.waterDisplacedDensity;
+		const float startingWaterDepth = SEA_LEVEL - cellHeight;
+		return startingWaterDepth <= 0 ? landHeight : oceanHeight;
+	}
+
+#if HEXPLANET_SIMD_SSE
+	/*! Relevels Lanes::Width listed cells of the store at once*/
+	template<typename Lanes>
+	static void relevelCellBlock(const FIsostasyTerms& terms, FCrustCellStore& crustCells, const int32* cellIndexes)
+	{
+		typedef typename Lanes::Register Register;
+		const int32 Width = Lanes::Width;
+		float laneValues[3][Width];
+		for (int32 lane = 0; lane < Width; ++lane)
+		{
+			laneValues[0][lane] = crustCells.cellHeights[cellIndexes[lane]];
+			laneValues[1][lane] = crustCells.crustThicknesses[cellIndexes[lane]];
+			laneValues[2][lane] = crustCells.crustDensities[cellIndexes[lane]];
+		}
+		const Register cellHeight = Lanes::Load(laneValues[0]);
+		const Register crustThickness = Lanes::Load(laneValues[1]);
+		const Register crustDensity = Lanes::Load(laneValues[2]);
+		const Register lithosphereDensity = Lanes::Set(terms.lithosphereDensity);
+
+		const Register cellDraft = Lanes::Divide(Lanes::Multiply(crustThickness, crustDensity), lithosphereDensity);
+		const Register landHeight = Lanes::Subtract(crustThickness, cellDraft);
+		const Register oceanHeight = Lanes::Divide(Lanes::Subtract(Lanes::Multiply(crustThickness, Lanes::Subtract(lithosphereDensity, crustDensity)),
+			Lanes::Set(terms.seaLevelWaterMass)), Lanes::Set(terms.waterDisplacedDensity));
+		const Register aboveWater = Lanes::LessEqual(Lanes::Subtract(Lanes::Set(SEA_LEVEL), cellHeight), Lanes::Set(0.0f));
+		Lanes::Store(laneValues[0], Lanes::Select(aboveWater, landHeight, oceanHeight));
+		for (int32 lane = 0; lane < Width; ++lane)
+		{
+			crustCells.cellHeights[cellIndexes[lane]] = laneValues[0][lane];
+		}
+	}
+#endif
+
+	float FTectonicSimulation::computeCellHeight(const float& cellHeight, const float& crustThickness, const float& crustDensity) const
+	{
+		return computeIsostaticHeight(FIsostasyTerms(settings), cellHeight, crustThickness, crustDensity);
+	}
+
+	void FTectonicSimulation::relevelCrustCells(const int32* cellIndexes, const int32& numCells)
+	{
+		const FIsostasyTerms terms(settings);
+		int32 cellNum = 0;
+#if HEXPLANET_SIMD_SSE
+		for (; cellNum + FSSELanes::Width <= numCells; cellNum += FSSELanes::Width)
+		{
+			relevelCellBlock<FSSELanes>(terms, crustCells, cellIndexes + cellNum);
+		}
+#endif
+		for (; cellNum < numCells; ++cellNum)
+		{
+			const int32 cellIndex = cellIndexes[cellNum];
+			crustCells.cellHeights[cellIndex] = computeIsostaticHeight(terms, crustCells.cellHeights[cellIndex],
+				crustCells.crustThicknesses[cellIndex], crustCells.crustDensities[cellIndex]);
+		}
+	}
+
+	void FTectonicSimulation::markCellDirty(const int32& cellIndex)
+	{
+		if (dirtyCellFlagsM.size() != size_t(crustCells.num()))
+		{
+			//the crust was replaced, whatever was noted against the old crust no longer applies
+			dirtyCellFlagsM.assign(crustCells.num(), 0);
+			dirtyCellsM.clear();
+		}
+		if (dirtyCellFlagsM[cellIndex] == 0)
+		{
+			dirtyCellFlagsM[cellIndex] = 1;
+			dirtyCellsM.push_back(cellIndex);
+		}
+	}
+
+	void FTectonicSimulation::relevelDirtyCells()
+	{
+		relevelCrustCells(dirtyCellsM.data(), int32(dirtyCellsM.size()));
+		for (const int32& cellIndex : dirtyCellsM)
+		{
+			dirtyCellFlagsM[cellIndex] = 0;
+		}
+		dirtyCellsM.clear();
+	}
+
+	FMatrix3f FTectonicSimulation::computePlateMotion(const FTectonicPlate& plate) const
+	{
+		if (plate.centerOfMassIndex == IndexNone)
+		{
+			return FMatrix3f::identity();
+		}
+		const FVector3f plateLocationOnSphere = gridM->getTileLocationOnSphere(plate.centerOfMassIndex);
+		const FVector3f& plateVelocity = plate.currentVelocity;
+		//first spin the plate about its center
+		//TODO add shear to this to model the tearing that would occur far from the plate center of rotation
+		const FMatrix3f plateSpin = FMatrix3f::fromAngleAxis(plateVelocity.Z, plateLocationOnSphere);
+		//then move the center by the spherical velocity, the azimuthal part is a turn about the pole and the polar
+		//part a turn along the meridian the center ends up on, every cell of the plate follows the center rigidly
+		const FMatrix3f azimuthalTurn = FMatrix3f::fromAngleAxis(plateVelocity.Y, FVector3f(0.0f, 0.0f, 1.0f));
+		const float movedAzimuth = plateLocationOnSphere.unitCartesianToSpherical().Y + plateVelocity.Y;
+		const FMatrix3f polarTurn = FMatrix3f::fromAngleAxis(plateVelocity.X, FVector3f(-std::sin(movedAzimuth), std::cos(movedAzimuth), 0.0f));
+		return polarTurn * (azimuthalTurn * plateSpin);
+	}
+
+	void FTectonicSimulation::updatePlateMotions()
+	{
+		plateMotionsM.resize(currentPlates.size());
+		for (size_t plateNum = 0; plateNum < currentPlates.size(); ++plateNum)
+		{
+			plateMotionsM[plateNum] = computePlateMotion(currentPlates[plateNum]);
+		}
+	}
+
+	FVector3f FTectonicSimulation::computeAdvectedCellPosition(const int32& tileIndex, const FMatrix3f& plateMotion, FVector2f& outCellVelocity) const
+	{
+		const FVector3f cellLocationOnSphere = gridM->getTileLocationOnSphere(tileIndex);
+		const FVector3f newLocationOnSphere = plateMotion.transformVector(cellLocationOnSphere);
+		FVector2f cellVelocity = newLocationOnSphere.unitCartesianToSpherical() - cellLocationOnSphere.unitCartesianToSpherical();
+		//keep the azimuthal step short when the cell crosses the date line
+		if (cellVelocity.Y > Pi)
+		{
+			cellVelocity.Y -= 2.0f * Pi;
+		}
+		else if (cellVelocity.Y < -Pi)
+		{
+			cellVelocity.Y += 2.0f * Pi;
+		}
+		outCellVelocity = cellVelocity;
+		return newLocationOnSphere;
+	}
+
+	void FTectonicSimulation::updateCellLocation(FCrustCell& cellToUpdate)
+	{
+		const FMatrix3f plateMotion = computePlateMotion(currentPlates[cellToUpdate.owningPlate]);
+		cellToUpdate.tileIndex = gridM->mapPosToTileIndex(computeAdvectedCellPosition(cellToUpdate.tileIndex, plateMotion, cellToUpdate.cellVelocity));
+	}
+
+	bool FTectonicSimulation::executeTimeStep()
+	{
+		//first erode the cells
+		erodeCells();
+
+		const int32 numCrustCells = crustCells.num();
+		const int32 CellsPerChunk = 4096;
+		const int32 numChunks = (numCrustCells + CellsPerChunk - 1) / CellsPerChunk;
+
+		//next move them, every chunk of cells is advected and mapped back onto the grid in one batch
+		updatePlateMotions();
+		advectedPositionsM.resize(numCrustCells);
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			const int32 chunkStart = chunkIndex*CellsPerChunk;
+			const int32 chunkEnd = std::min(numCrustCells, chunkStart + CellsPerChunk);
+			for (int32 cellIndex = chunkStart; cellIndex < chunkEnd; ++cellIndex)
+			{
+				advectedPositionsM[cellIndex] = computeAdvectedCellPosition(crustCells.tileIndexes[cellIndex],
+					plateMotionsM[crustCells.owningPlates[cellIndex]], crustCells.cellVelocities[cellIndex]);
+			}
+			gridM->mapPositionsToTileIndexes(advectedPositionsM.data() + chunkStart, crustCells.tileIndexes.data() + chunkStart, chunkEnd - chunkStart);
+		});
+
+		//group the cells by the tile they land on with a counting sort, the cells landing on tile t are
+		//arrivingCellsM[arrivalOffsetsM[t]] up to arrivingCellsM[arrivalOffsetsM[t+1]]
+		arrivalCountsM.assign(numCrustCells, FAtomicCounter());
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			const int32 chunkEnd = std::min(numCrustCells, (chunkIndex + 1)*CellsPerChunk);
+			for (int32 cellIndex = chunkIndex*CellsPerChunk; cellIndex < chunkEnd; ++cellIndex)
+			{
+				arrivalCountsM[crustCells.tileIndexes[cellIndex]].value.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+		arrivalOffsetsM.resize(numCrustCells + 1);
+		arrivalOffsetsM[0] = 0;
+		for (int32 tileIndex = 0; tileIndex < numCrustCells; ++tileIndex)
+		{
+			std::atomic<int32>& arrivalCount = arrivalCountsM[tileIndex].value;
+			arrivalOffsetsM[tileIndex + 1] = arrivalOffsetsM[tileIndex] + arrivalCount.load(std::memory_order_relaxed);
+			arrivalCount.store(arrivalOffsetsM[tileIndex], std::memory_order_relaxed);
+		}
+		arrivingCellsM.resize(numCrustCells);
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			const int32 chunkEnd = std::min(numCrustCells, (chunkIndex + 1)*CellsPerChunk);
+			for (int32 cellIndex = chunkIndex*CellsPerChunk; cellIndex < chunkEnd; ++cellIndex)
+			{
+				arrivingCellsM[arrivalCountsM[crustCells.tileIndexes[cellIndex]].value.fetch_add(1, std::memory_order_relaxed)] = cellIndex;
+			}
+		});
+
+		//every tile settles the cells landing on it on its own, in the order of the tiles they came from, what
+		//each cell's arrival pushed off the tile is noted against that cell
+		newCrustCellsM.resize(numCrustCells);
+		arrivalOutcomesM.assign(numCrustCells, ECrustArrival::Settled);
+		displacedCellsM.resize(numCrustCells);
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			const int32 chunkEnd = std::min(numCrustCells, (chunkIndex + 1)*CellsPerChunk);
+			for (int32 tileIndex = chunkIndex*CellsPerChunk; tileIndex < chunkEnd; ++tileIndex)
+			{
+				int32* tileArrivals = arrivingCellsM.data() + arrivalOffsetsM[tileIndex];
+				const int32 numArrivals = arrivalOffsetsM[tileIndex + 1] - arrivalOffsetsM[tileIndex];
+				if (numArrivals == 0)
+				{
+					//create new crust where we don't have a plate owning the area
+					buildNewCrustFromPlateDivergence(tileIndex, newCrustCellsM);
+					continue;
+				}
+				//the threads fill the runs in any order, sorting them is what makes the outcome the same on every run
+				std::sort(tileArrivals, tileArrivals + numArrivals);
+				//this location hasn't been claimed yet no collision here
+				FCrustCell settledCell = crustCells.getCell(tileArrivals[0]);
+				for (int32 arrivalNum = 1; arrivalNum < numArrivals; ++arrivalNum)
+				{
+					const int32 arrivingCellIndex = tileArrivals[arrivalNum];
+					arrivalOutcomesM[arrivingCellIndex] = uint8(settleArrivingCell(settledCell, crustCells.getCell(arrivingCellIndex), displacedCellsM[arrivingCellIndex]));
+				}
+				newCrustCellsM.setCell(tileIndex, settledCell);
+			}
+		});
+
+		//gather the collisions in the order of the cells that caused them
+		std::vector<FCrustCell>& subductions = subductionsM;
+		std::vector<FCrustCell>& collisions = collisionsM;
+		subductions.clear();
+		collisions.clear();
+		for (int32 cellIndex = 0; cellIndex < numCrustCells; ++cellIndex)
+		{
+			if (arrivalOutcomesM[cellIndex] == ECrustArrival::Subducted)
+			{
+				subductions.push_back(displacedCellsM[cellIndex]);
+			}
+			else if (arrivalOutcomesM[cellIndex] == ECrustArrival::Collided)
+			{
+				collisions.push_back(displacedCellsM[cellIndex]);
+			}
+		}
+
+		//transfer the data, the crust before the move stays in newCrustCellsM to be overwritten next step
+		crustCells.swap(newCrustCellsM);
+
+		for (FTectonicPlate& tecPlate : currentPlates)
+		{
+			tecPlate.ownedCrustCells.clear();
+		}
+
+		//now we can update the plates as to who the own now
+		for (int32 cellIndex = 0; cellIndex < numCrustCells; ++cellIndex)
+		{
+			currentPlates[crustCells.owningPlates[cellIndex]].ownedCrustCells.push_back(crustCells.tileIndexes[cellIndex]);
+		}
+
+		//alright, now we can handle each collision
+		for (FCrustCell& collisionLocation : subductions)
+		{
+			//the amount of crust that gets scrapped off is based upon how hard the
+			//plate will be pushed against the overlapping plate once it is no longer held down
+			//by water
+			//right now we're going to say that its everything about the isostatic zero line
+			float percentCrustToTransfer = collisionLocation.crustDensity / settings.lithosphereDensity;
+			const FCrustCell targetCell = crustCells.getCell(collisionLocation.tileIndex);
+			//get the cells surrounding the targetCell
+			std::vector<int32> potentialLocations = gridM->getTileIndexesNStepsAwayFromIndex(collisionLocation.tileIndex, settings.radiusAboutCollisionCellToDistributeCrust);
+			FTectonicPlate& targetPlate = currentPlates[targetCell.owningPlate];
+			scatterMassOverArea(targetPlate, potentialLocations, collisionLocation, percentCrustToTransfer);
+			float massTransfered = percentCrustToTransfer*collisionLocation.crustThickness*collisionLocation.crustDensity;
+			FVector2f velocityChange = targetCell.cellVelocity - collisionLocation.cellVelocity;
+			velocityChange *= massTransfered;
+			applyForceToPlate(targetPlate,targetCell.tileIndex, velocityChange);
+		}
+		for (FCrustCell& collisionLocation : collisions)
+		{
+			//we're going to scatter the crust from the collision around the area,
+			//with the folding ratio being transfered to the new plate and the rest staying on this plate
+			const FCrustCell targetCell = crustCells.getCell(collisionLocation.tileIndex);
+			FTectonicPlate& targetPlate = currentPlates[targetCell.owningPlate];
+			FTectonicPlate& smallerPlate = currentPlates[collisionLocation.owningPlate];
+			float dyingCellMass = collisionLocation.crustDensity*collisionLocation.crustThickness;
+			float massToTransfer = dyingCellMass*settings.foldingRatio;
+			float massToKeep = dyingCellMass - massToTransfer;
+			applyForceToPlate(targetPlate, targetCell.tileIndex, (targetCell.cellVelocity-collisionLocation.cellVelocity)*massToTransfer);
+			applyForceToPlate(smallerPlate, targetCell.tileIndex, (collisionLocation.cellVelocity-targetCell.cellVelocity)*massToTransfer);
+			//get the cells surrounding the targetCell
+			std::vector<int32> potentialLocations = gridM->getTileIndexesNStepsAwayFromIndex(collisionLocation.tileIndex, settings.radiusAboutCollisionCellToDistributeCrust);
+			scatterMassOverArea(targetPlate, potentialLocations, collisionLocation, settings.foldingRatio);
+			if (!scatterMassOverArea(smallerPlate, potentialLocations, collisionLocation, 1-settings.foldingRatio))
+			{
+				//if there isn't anywhere left on the smaller plate to recieve it, put it all on the bigger plate
+				scatterMassOverArea(targetPlate, potentialLocations, collisionLocation, 1 - settings.foldingRatio);
+				applyForceToPlate(targetPlate, targetCell.tileIndex, (targetCell.cellVelocity - collisionLocation.cellVelocity)*massToKeep);
+			}
+		}
+
+		//the crust scattered by the collisions settles in one pass before the plate centers are weighed
+		relevelDirtyCells();
+
+		for (FTectonicPlate& tecPlate : currentPlates)
+		{
+			updatePlateCenterOfMass(tecPlate);
+		}
+
+		++simulationTimeStep;
+		//return whether or not we had any continental collisions
+		return collisions.size() > 0;
+	}
+
+	ECrustArrival::Type FTectonicSimulation::settleArrivingCell(FCrustCell& settledCell, const FCrustCell& arrivingCell, FCrustCell& outDisplacedCell) const
+	{
+		if (settledCell.owningPlate == arrivingCell.owningPlate)
+		{
+			//we're piling up on ourselves
+			//just add our mass to the existing tile mass
+			transferCrustFromTargetCellToExistingCell(settledCell, arrivingCell, 1.0);
+			return ECrustArrival::Settled;
+		}
+
+		//we have a collision
+		const float baseContinentalHeight = settings.baseContinentalHeight;
+		const bool prev_is_oceanic = crustCells.cellHeights[settledCell.tileIndex] < baseContinentalHeight;
+		const bool this_is_oceanic = arrivingCell.cellHeight < baseContinentalHeight;
+
+		int32 prev_TimeStamp = settledCell.cellTimeStamp;
+		int32 my_TimeStamp = arrivingCell.cellTimeStamp;
+		//find out which cell gets subducted (i.e. is less buoyant),
+		//its either the lower one or the younger one
+
+		const bool prev_is_buoyant = (settledCell.cellHeight > arrivingCell.cellHeight)
+			|| ((settledCell.cellHeight + 2 * std::numeric_limits<float>::epsilon() > arrivingCell.cellHeight)
+				&& (settledCell.cellHeight < arrivingCell.cellHeight + 2 * std::numeric_limits<float>::epsilon())
+				&& ((prev_TimeStamp > my_TimeStamp) //if they're effectively the same height take the younger one
+					|| (prev_TimeStamp == my_TimeStamp  //in order to maintain a consistent choice, if they are the same age,
+														//take the plate with the lower index number
+						&& settledCell.owningPlate < arrivingCell.owningPlate)));
+
+		if (this_is_oceanic && prev_is_buoyant)
+		{
+			//this plate is being subducted
+			//we're going underneath the other plate
+			outDisplacedCell = arrivingCell;
+			return ECrustArrival::Subducted;
+		}
+		else if (prev_is_oceanic)
+		{
+			//this other plate is being subducted
+			//add a reference to the previous ownerPlate's local crustcell
+			outDisplacedCell = settledCell;
+			settledCell = arrivingCell;
+			return ECrustArrival::Subducted;
+		}
+		//we're just straight colliding
+		//the bigger plate gets ownership
+		if (currentPlates[arrivingCell.owningPlate].plateTotalMass > currentPlates[settledCell.owningPlate].plateTotalMass)
+		{
+			//we're the bigger plate, take ownership
+			outDisplacedCell = settledCell;
+			settledCell = arrivingCell;
+		}
+		else
+		{
+			outDisplacedCell = arrivingCell;
+		}
+		return ECrustArrival::Collided;
+	}
+
+	/*! Mixes part of the target cell's crust into existing crust without touching its height*/
+	static void mixCrust(float& crustThickness, float& crustDensity, const FCrustCell& targetCell, float percentCrustTransfer)
+	{
+		float totalThickness = crustThickness + targetCell.crustThickness * percentCrustTransfer;
+		float weightedDensity = crustThickness * crustDensity
+			+ targetCell.crustDensity*targetCell.crustThickness * percentCrustTransfer;
+		crustThickness = totalThickness;
+		crustDensity = weightedDensity / totalThickness;
+	}
+
+	void FTectonicSimulation::transferCrustFromTargetCellToExistingCell(FCrustCell &existingCrust, const FCrustCell &targetCell, float percentCrustTransfer) const
+	{
+		mixCrust(existingCrust.crustThickness, existingCrust.crustDensity, targetCell, percentCrustTransfer);
+		updateCrustCellHeight(existingCrust);
+	}
+
+	void FTectonicSimulation::applyForceToPlate(FTectonicPlate& targetPlate, const int32& forceLocationIndex, const FVector2f& sphericalForce) const
+	{
+		//for simplicities sake, we're just going to treat spherical coordinates like we're in 2d
+		FVector2f plateCenter = gridM->getTileLocationOnSphere(targetPlate.centerOfMassIndex).unitCartesianToSpherical();
+		FVector2f forceLoc = gridM->getTileLocationOnSphere(forceLocationIndex).unitCartesianToSpherical();
+		FVector2f forceMomentArm = forceLoc - plateCenter;
+		//break the force down into it's components;
+		float forceMomentArmLength = forceMomentArm.size();
+		FVector2f alignedForce(0.0,0.0);
+		float forceTorque = 0.0;
+		if (forceMomentArmLength > std::numeric_limits<float>::epsilon())
+		{
+			FVector2f momentArmDir = forceMomentArm / std::sqrt(FVector2f::dotProduct(forceMomentArm, forceMomentArm));
+			alignedForce = FVector2f::dotProduct(sphericalForce, momentArmDir)*momentArmDir;
+			forceTorque = FVector2f::crossProduct(sphericalForce, forceMomentArm);
+		}
+		else
+		{
+			alignedForce = sphericalForce;
+			forceTorque = 0.0;
+		}
+		FVector3f plateAcceleration;
+		plateAcceleration.X = alignedForce.X / targetPlate.plateTotalMass;
+		plateAcceleration.Y = alignedForce.Y / targetPlate.plateTotalMass;
+		plateAcceleration.Z = forceTorque / targetPlate.plateTotalMass;
+		targetPlate.currentVelocity += plateAcceleration;
+	}
+
+	//the transfer ratio is unused, the scattered crust has always been scaled by settings.foldingRatio and switching
+	//to the ratio the callers pass would change every generated planet, it stays in the signature for the blueprint API
+	bool FTectonicSimulation::scatterMassOverArea(FTectonicPlate& targetPlate, std::vector<int32> potentialLocations, const FCrustCell& collisionLocation, float /*transferRatio*/)
+	{
+		potentialLocations.erase(std::remove_if(potentialLocations.begin(), potentialLocations.end(), [&](const int32& cellIndex)->bool
+		{
+			return crustCells.owningPlates[cellIndex] != targetPlate.plateIndex;
+		}), potentialLocations.end());
+		//get noise for each location
+		std::vector<float> locationArray;
+		locationArray.reserve(potentialLocations.size());
+		float totalNoise = 0.0;
+		for (const int32& targetLoc : potentialLocations)
+		{
+			FVector2f targetSphericalLoc = gridM->getTileLocationOnSphere(targetLoc).unitCartesianToSpherical();
+			float locationNoise = noiseM.simplexNoiseInRange2D(targetSphericalLoc.X, targetSphericalLoc.Y, 0.0, 1.0);
+			totalNoise += locationNoise;
+			locationArray.push_back(locationNoise);
+		}
+		//normalize the noise so that it adds up to the folding ratio
+		//and add that much mass to that cell
+		for (size_t targetIndex = 0; targetIndex < potentialLocations.size(); ++targetIndex)
+		{
+			const int32 cellIndex = potentialLocations[targetIndex];
+			mixCrust(crustCells.crustThicknesses[cellIndex], crustCells.crustDensities[cellIndex], collisionLocation,
+				settings.foldingRatio*locationArray[targetIndex] / totalNoise);
+			markCellDirty(cellIndex);
+		}
+		return potentialLocations.size() != 0;
+	}
+
+	void FTectonicSimulation::buildNewCrustFromPlateDivergence(const int32& locationIndex, FCrustCellStore& newCrustData) const
+	{
+		FCrustCell newCrust = createBaseCrustCell(locationIndex, float(settings.baseContinentalHeight * 0.1));
+		newCrust.owningPlate = crustCells.owningPlates[locationIndex];
+		newCrustData.setCell(locationIndex, newCrust);
+	}
+}
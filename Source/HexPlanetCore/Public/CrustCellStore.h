@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HexPlanetMath.h"
+#include <vector>
+
+namespace HexPlanet
+{
+	/*!
+	* \struct FCrustCell
+	* \brief The crust sitting on one tile
+	*/
+	struct FCrustCell
+	{
+		FCrustCell()
+			: tileIndex(IndexNone), cellHeight(0.0f), crustThickness(0.0f), crustArea(0.0f), crustDensity(0.0f),
+			owningPlate(IndexNone), cellTimeStamp(0), cellVelocity(0.0f, 0.0f)
+		{
+		}
+
+		int32 tileIndex;
+		float cellHeight;
+		float crustThickness;
+		float crustArea;
+		float crustDensity; //Gg/m^3
+		int32 owningPlate;
+		int32 cellTimeStamp;
+		FVector2f cellVelocity;
+	};
+
+	/*!
+	* \struct FCrustCellStore
+	* \brief The crust of every tile, kept as one contiguous column per field
+	* \details Loops that only touch a few fields of every cell run over packed arrays of just those
+	* fields. Swapping two stores swaps their columns without copying, which is how the simulation
+	* keeps the crust before and after a step side by side. getCell and setCell gather and scatter
+	* one whole cell for the code that works a cell at a time
+	*/
+	struct HEXPLANETCORE_API FCrustCellStore
+	{
+		/*! Resizes every column, new cells are left as default FCrustCells*/
+		void resize(int32 numCells);
+		int32 num() const;
+		FCrustCell getCell(int32 cellIndex) const;
+		void setCell(int32 cellIndex, const FCrustCell& crustCell);
+		/*! Exchanges the columns of the two stores*/
+		void swap(FCrustCellStore& other);
+		/*! Copies every cell out into an array of cells, for callers that want the crust as whole cells*/
+		void exportCells(std::vector<FCrustCell>& outCrustCells) const;
+		void importCells(const std::vector<FCrustCell>& crustCells);
+
+		std::vector<int32> tileIndexes;
+		std::vector<float> cellHeights;
+		std::vector<float> crustThicknesses;
+		std::vector<float> crustAreas;
+		std::vector<float> crustDensities; //Gg/m^3
+		std::vector<int32> owningPlates;
+		std::vector<int32> cellTimeStamps;
+		std::vector<FVector2f> cellVelocities;
+	};
+
+	HEXPLANET_FORCEINLINE int32 FCrustCellStore::num() const
+	{
+		return int32(tileIndexes.size());
+	}
+
+	HEXPLANET_FORCEINLINE FCrustCell FCrustCellStore::getCell(int32 cellIndex) const
+	{
+		FCrustCell crustCell;
+		crustCell.tileIndex = tileIndexes[cellIndex];
+		crustCell.cellHeight = cellHeights[cellIndex];
+		crustCell.crustThickness = crustThicknesses[cellIndex];
+		crustCell.crustArea = crustAreas[cellIndex];
+		crustCell.crustDensity = crustDensities[cellIndex];
+		crustCell.owningPlate = owningPlates[cellIndex];
+		crustCell.cellTimeStamp = cellTimeStamps[cellIndex];
+		crustCell.cellVelocity = cellVelocities[cellIndex];
+		return crustCell;
+	}
+
+	HEXPLANET_FORCEINLINE void FCrustCellStore::setCell(int32 cellIndex, const FCrustCell& crustCell)
+	{
+		tileIndexes[cellIndex] = crustCell.tileIndex;
+		cellHeights[cellIndex] = crustCell.cellHeight;
+		crustThicknesses[cellIndex] = crustCell.crustThickness;
+		crustAreas[cellIndex] = crustCell.crustArea;
+		crustDensities[cellIndex] = crustCell.crustDensity;
+		owningPlates[cellIndex] = crustCell.owningPlate;
+		cellTimeStamps[cellIndex] = crustCell.cellTimeStamp;
+		cellVelocities[cellIndex] = crustCell.cellVelocity;
+	}
+}
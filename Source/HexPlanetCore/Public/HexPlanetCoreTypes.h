@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+//the core builds both as an engine module, where the build tool defines the export macro, and as a plain library
+#ifndef HEXPLANETCORE_API
+#define HEXPLANETCORE_API
+#endif
+
+/*! Always checked outside of release builds, like the engine's check*/
+#define HEXPLANET_CHECK(expression) assert(expression)
+/*! Only checked when HEXPLANET_DO_CHECK_SLOW is set, for checks in the hot loops*/
+#if HEXPLANET_DO_CHECK_SLOW
+#define HEXPLANET_CHECK_SLOW(expression) assert(expression)
+#else
+#define HEXPLANET_CHECK_SLOW(expression)
+#endif
+
+#if defined(_MSC_VER)
+#define HEXPLANET_FORCEINLINE __forceinline
+#else
+#define HEXPLANET_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+/*!
+* \namespace HexPlanet
+* \brief The grid, plate simulation and noise algorithms, free of any engine dependency
+* \details The engine components are thin wrappers over the classes in here, so the same
+* generation runs inside the editor and headless on build and render farm machines
+*/
+namespace HexPlanet
+{
+	typedef std::int8_t int8;
+	typedef std::uint8_t uint8;
+	typedef std::int16_t int16;
+	typedef std::uint16_t uint16;
+	typedef std::int32_t int32;
+	typedef std::uint32_t uint32;
+	typedef std::int64_t int64;
+	typedef std::uint64_t uint64;
+
+	const int32 IndexNone = -1;
+	const float Pi = 3.1415926535897932f;
+	const float SmallNumber = 1.e-8f;
+	const float KindaSmallNumber = 1.e-4f;
+}
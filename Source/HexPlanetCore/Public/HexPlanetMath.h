@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HexPlanetCoreTypes.h"
+#include <cmath>
+
+namespace HexPlanet
+{
+	template<typename T> struct TVector2;
+
+	/*! acos with the argument clamped to [-1, 1] first, dot products of unit vectors can land just outside it*/
+	template<typename T>
+	HEXPLANET_FORCEINLINE T acosClamped(T value)
+	{
+		return std::acos(value < T(-1) ? T(-1) : (value < T(1) ? value : T(1)));
+	}
+
+	/*!
+	* \struct TVector3
+	* \brief A three component vector with the operations the grid and the simulation need
+	* \details Laid out as three packed components so arrays of engine vectors can be handed
+	* to the batched queries without copying
+	*/
+	template<typename T>
+	struct TVector3
+	{
+		T X;
+		T Y;
+		T Z;
+
+		TVector3()
+		{
+		}
+		TVector3(T inX, T inY, T inZ)
+			: X(inX), Y(inY), Z(inZ)
+		{
+		}
+
+		HEXPLANET_FORCEINLINE T& operator[](int32 axis) { return (&X)[axis]; }
+		HEXPLANET_FORCEINLINE const T& operator[](int32 axis) const { return (&X)[axis]; }
+
+		HEXPLANET_FORCEINLINE TVector3 operator+(const TVector3& other) const { return TVector3(X + other.X, Y + other.Y, Z + other.Z); }
+		HEXPLANET_FORCEINLINE TVector3 operator-(const TVector3& other) const { return TVector3(X - other.X, Y - other.Y, Z - other.Z); }
+		HEXPLANET_FORCEINLINE TVector3 operator-() const { return TVector3(-X, -Y, -Z); }
+		HEXPLANET_FORCEINLINE TVector3 operator*(T scale) const { return TVector3(X * scale, Y * scale, Z * scale); }
+		HEXPLANET_FORCEINLINE TVector3 operator/(T scale) const { const T invScale = T(1) / scale; return TVector3(X * invScale, Y * invScale, Z * invScale); }
+		HEXPLANET_FORCEINLINE friend TVector3 operator*(T scale, const TVector3& vector) { return vector * scale; }
+		HEXPLANET_FORCEINLINE TVector3& operator+=(const TVector3& other) { X += other.X; Y += other.Y; Z += other.Z; return *this; }
+		HEXPLANET_FORCEINLINE TVector3& operator-=(const TVector3& other) { X -= other.X; Y -= other.Y; Z -= other.Z; return *this; }
+		HEXPLANET_FORCEINLINE TVector3& operator*=(T scale) { X *= scale; Y *= scale; Z *= scale; return *this; }
+		HEXPLANET_FORCEINLINE TVector3& operator/=(T scale) { const T invScale = T(1) / scale; X *= invScale; Y *= invScale; Z *= invScale; return *this; }
+
+		HEXPLANET_FORCEINLINE static T dotProduct(const TVector3& a, const TVector3& b) { return a.X * b.X + a.Y * b.Y + a.Z * b.Z; }
+		HEXPLANET_FORCEINLINE static TVector3 crossProduct(const TVector3& a, const TVector3& b)
+		{
+			return TVector3(a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X);
+		}
+		HEXPLANET_FORCEINLINE T sizeSquared() const { return X * X + Y * Y + Z * Z; }
+		HEXPLANET_FORCEINLINE T size() const { return std::sqrt(sizeSquared()); }
+
+		/*! The unit vector in the same direction, zero if the vector is too short to have one*/
+		TVector3 getSafeNormal() const
+		{
+			const T squareSum = sizeSquared();
+			if (squareSum == T(1))
+			{
+				return *this;
+			}
+			if (squareSum < T(SmallNumber))
+			{
+				return TVector3(0, 0, 0);
+			}
+			return *this * (T(1) / std::sqrt(squareSum));
+		}
+		void toDirectionAndLength(TVector3& outDirection, T& outLength) const
+		{
+			outLength = size();
+			if (outLength > T(SmallNumber))
+			{
+				outDirection = *this * (T(1) / outLength);
+			}
+			else
+			{
+				outDirection = TVector3(0, 0, 0);
+			}
+		}
+		/*! Rotates the vector by angleDeg degrees about a unit axis*/
+		TVector3 rotateAngleAxis(T angleDeg, const TVector3& axis) const
+		{
+			const T angle = angleDeg * T(Pi) / T(180);
+			const T sinAngle = std::sin(angle);
+			const T cosAngle = std::cos(angle);
+			const T xx = axis.X * axis.X;
+			const T yy = axis.Y * axis.Y;
+			const T zz = axis.Z * axis.Z;
+			const T xy = axis.X * axis.Y;
+			const T yz = axis.Y * axis.Z;
+			const T zx = axis.Z * axis.X;
+			const T xs = axis.X * sinAngle;
+			const T ys = axis.Y * sinAngle;
+			const T zs = axis.Z * sinAngle;
+			const T omc = T(1) - cosAngle;
+			return TVector3(
+				(omc * xx + cosAngle) * X + (omc * xy - zs) * Y + (omc * zx + ys) * Z,
+				(omc * xy + zs) * X + (omc * yy + cosAngle) * Y + (omc * yz - xs) * Z,
+				(omc * zx - ys) * X + (omc * yz + xs) * Y + (omc * zz + cosAngle) * Z);
+		}
+		/*! The polar and azimuthal angle of a unit vector*/
+		TVector2<T> unitCartesianToSpherical() const;
+	};
+
+	/*!
+	* \struct TVector2
+	* \brief A two component vector, mostly used for spherical coordinates
+	*/
+	template<typename T>
+	struct TVector2
+	{
+		T X;
+		T Y;
+
+		TVector2()
+		{
+		}
+		TVector2(T inX, T inY)
+			: X(inX), Y(inY)
+		{
+		}
+
+		HEXPLANET_FORCEINLINE TVector2 operator+(const TVector2& other) const { return TVector2(X + other.X, Y + other.Y); }
+		HEXPLANET_FORCEINLINE TVector2 operator-(const TVector2& other) const { return TVector2(X - other.X, Y - other.Y); }
+		HEXPLANET_FORCEINLINE TVector2 operator*(T scale) const { return TVector2(X * scale, Y * scale); }
+		HEXPLANET_FORCEINLINE TVector2 operator/(T scale) const { const T invScale = T(1) / scale; return TVector2(X * invScale, Y * invScale); }
+		HEXPLANET_FORCEINLINE friend TVector2 operator*(T scale, const TVector2& vector) { return vector * scale; }
+		HEXPLANET_FORCEINLINE TVector2& operator+=(const TVector2& other) { X += other.X; Y += other.Y; return *this; }
+		HEXPLANET_FORCEINLINE TVector2& operator*=(T scale) { X *= scale; Y *= scale; return *this; }
+
+		HEXPLANET_FORCEINLINE static T dotProduct(const TVector2& a, const TVector2& b) { return a.X * b.X + a.Y * b.Y; }
+		HEXPLANET_FORCEINLINE static T crossProduct(const TVector2& a, const TVector2& b) { return a.X * b.Y - a.Y * b.X; }
+		HEXPLANET_FORCEINLINE T size() const { return std::sqrt(X * X + Y * Y); }
+
+		/*! The unit vector for a polar angle X and an azimuthal angle Y*/
+		TVector3<T> sphericalToUnitCartesian() const
+		{
+			const T sinTheta = std::sin(X);
+			return TVector3<T>(std::cos(Y) * sinTheta, std::sin(Y) * sinTheta, std::cos(X));
+		}
+	};
+
+	template<typename T>
+	TVector2<T> TVector3<T>::unitCartesianToSpherical() const
+	{
+		return TVector2<T>(acosClamped(Z / size()), std::atan2(Y, X));
+	}
+
+	/*!
+	* \struct TMatrix3
+	* \brief A 3x3 matrix stored by rows, used for rotations of positions on the sphere
+	*/
+	template<typename T>
+	struct TMatrix3
+	{
+		TVector3<T> rows[3];
+
+		static TMatrix3 identity()
+		{
+			TMatrix3 identityMatrix;
+			identityMatrix.rows[0] = TVector3<T>(1, 0, 0);
+			identityMatrix.rows[1] = TVector3<T>(0, 1, 0);
+			identityMatrix.rows[2] = TVector3<T>(0, 0, 1);
+			return identityMatrix;
+		}
+		/*! The rotation by angle radians about a unit axis, the same rotation rotateAngleAxis applies*/
+		static TMatrix3 fromAngleAxis(T angle, const TVector3<T>& axis)
+		{
+			const T sinAngle = std::sin(angle);
+			const T cosAngle = std::cos(angle);
+			const T omc = T(1) - cosAngle;
+			TMatrix3 rotation;
+			rotation.rows[0] = TVector3<T>(omc * axis.X * axis.X + cosAngle, omc * axis.X * axis.Y - axis.Z * sinAngle, omc * axis.Z * axis.X + axis.Y * sinAngle);
+			rotation.rows[1] = TVector3<T>(omc * axis.X * axis.Y + axis.Z * sinAngle, omc * axis.Y * axis.Y + cosAngle, omc * axis.Y * axis.Z - axis.X * sinAngle);
+			rotation.rows[2] = TVector3<T>(omc * axis.Z * axis.X - axis.Y * sinAngle, omc * axis.Y * axis.Z + axis.X * sinAngle, omc * axis.Z * axis.Z + cosAngle);
+			return rotation;
+		}
+
+		HEXPLANET_FORCEINLINE TVector3<T> transformVector(const TVector3<T>& vector) const
+		{
+			return TVector3<T>(TVector3<T>::dotProduct(rows[0], vector), TVector3<T>::dotProduct(rows[1], vector), TVector3<T>::dotProduct(rows[2], vector));
+		}
+		/*! Applies other first and then this matrix*/
+		TMatrix3 operator*(const TMatrix3& other) const
+		{
+			TMatrix3 product;
+			for (int32 rowNum = 0; rowNum < 3; ++rowNum)
+			{
+				for (int32 columnNum = 0; columnNum < 3; ++columnNum)
+				{
+					product.rows[rowNum][columnNum] = rows[rowNum].X * other.rows[0][columnNum]
+						+ rows[rowNum].Y * other.rows[1][columnNum] + rows[rowNum].Z * other.rows[2][columnNum];
+				}
+			}
+			return product;
+		}
+	};
+
+	typedef TVector3<float> FVector3f;
+	typedef TVector3<double> FVector3d;
+	typedef TVector2<float> FVector2f;
+	typedef TMatrix3<float> FMatrix3f;
+
+	/*! Rounds halves the same way as the engine and the SIMD paths, by rounding twice the value to nearest*/
+	HEXPLANET_FORCEINLINE int32 roundToInt(float value)
+	{
+		return int32(std::lrint(value + value + 0.5f)) >> 1;
+	}
+	HEXPLANET_FORCEINLINE int32 roundToInt(double value)
+	{
+		return int32(std::lrint(value + value + 0.5)) >> 1;
+	}
+	HEXPLANET_FORCEINLINE int32 floorToInt(float value)
+	{
+		return int32(std::floor(value));
+	}
+	HEXPLANET_FORCEINLINE int32 ceilToInt(double value)
+	{
+		return int32(std::ceil(value));
+	}
+	template<typename T>
+	HEXPLANET_FORCEINLINE T clampValue(const T& value, const T& minValue, const T& maxValue)
+	{
+		return value < minValue ? minValue : (value > maxValue ? maxValue : value);
+	}
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HexPlanetCoreTypes.h"
+#include <atomic>
+#include <functional>
+
+namespace HexPlanet
+{
+	typedef std::function<void(int32)> FParallelForBody;
+	/*! Runs body once for every index in [0, num) and returns once all of them are done*/
+	typedef void(*FParallelForExecutor)(int32 num, const FParallelForBody& body);
+
+	/*!
+	* Hands the parallel loops of the core to another scheduler, the engine module routes them through
+	* its task graph. Passing null restores the default, which spreads the indexes over one
+	* std::thread per hardware thread
+	*/
+	HEXPLANETCORE_API void setParallelForExecutor(FParallelForExecutor executor);
+	/*! Runs body for every index in [0, num) in parallel, indexes are handed out in no particular order*/
+	HEXPLANETCORE_API void parallelFor(int32 num, const FParallelForBody& body);
+
+	/*!
+	* \struct FAtomicCounter
+	* \brief An atomic count that can be kept in a std::vector
+	* \details Copying one copies its current value, which is only meaningful while no other thread is counting
+	*/
+	struct FAtomicCounter
+	{
+		FAtomicCounter()
+			: value(0)
+		{
+		}
+		FAtomicCounter(const FAtomicCounter& other)
+			: value(other.value.load(std::memory_order_relaxed))
+		{
+		}
+		FAtomicCounter& operator=(const FAtomicCounter& other)
+		{
+			value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			return *this;
+		}
+
+		std::atomic<int32> value;
+	};
+}
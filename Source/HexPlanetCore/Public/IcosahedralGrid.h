@@ -0,0 +1,653 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HexPlanetMath.h"
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace HexPlanet
+{
+	/*!
+	* \struct FGridIndex
+	* \brief A position in the Rectilinear Grid
+	*/
+	struct FGridIndex
+	{
+		int32 uPos;
+		int32 vPos;
+	};
+
+	/*!
+	* \struct FTileIndexView
+	* \brief A non owning view over a contiguous run of tile indexes
+	* \details Views handed out by the grid point directly into the grid's
+	* tables, they remain valid until the grid is rebuilt
+	*/
+	struct FTileIndexView
+	{
+		FTileIndexView()
+			: tileIndexes(nullptr), numTileIndexes(0)
+		{
+		}
+		FTileIndexView(const int32* firstTileIndex, int32 numIndexes)
+			: tileIndexes(firstTileIndex), numTileIndexes(numIndexes)
+		{
+		}
+
+		HEXPLANET_FORCEINLINE int32 Num() const { return numTileIndexes; }
+		HEXPLANET_FORCEINLINE const int32& operator[](int32 index) const
+		{
+			HEXPLANET_CHECK_SLOW(index >= 0 && index < numTileIndexes);
+			return tileIndexes[index];
+		}
+		HEXPLANET_FORCEINLINE const int32* begin() const { return tileIndexes; }
+		HEXPLANET_FORCEINLINE const int32* end() const { return tileIndexes + numTileIndexes; }
+		/*! Copies the viewed indexes into an owning array*/
+		std::vector<int32> toArray() const { return std::vector<int32>(begin(), end()); }
+
+	private:
+		const int32* tileIndexes;
+		int32 numTileIndexes;
+	};
+
+	/*!
+	* \struct TTopologyTable
+	* \brief A read only table of the grid topology
+	* \details A table either owns elements built in process or views elements that live in
+	* a memory mapped topology cache, reads go through the same pointer either way. Tables are
+	* indexed with 64 bits, the per neighbor tables outgrow int32 at high frequencies
+	*/
+	template<typename ElementType>
+	struct TTopologyTable
+	{
+		TTopologyTable()
+			: elements(nullptr), numElements(0)
+		{
+		}
+		TTopologyTable(const TTopologyTable& other)
+			: elements(nullptr), numElements(0)
+		{
+			*this = other;
+		}
+		TTopologyTable& operator=(const TTopologyTable& other)
+		{
+			if (this != &other)
+			{
+				const bool otherOwnsElements = other.ownsElements();
+				ownedElements = other.ownedElements;
+				elements = otherOwnsElements ? ownedElements.data() : other.elements;
+				numElements = other.numElements;
+			}
+			return *this;
+		}
+		TTopologyTable(TTopologyTable&& other)
+			: elements(nullptr), numElements(0)
+		{
+			*this = std::move(other);
+		}
+		/*! Moving hands over owned elements without copying them, so views of them stay valid*/
+		TTopologyTable& operator=(TTopologyTable&& other)
+		{
+			if (this != &other)
+			{
+				const bool otherOwnsElements = other.ownsElements();
+				ownedElements = std::move(other.ownedElements);
+				elements = otherOwnsElements ? ownedElements.data() : other.elements;
+				numElements = other.numElements;
+				other.ownedElements.clear();
+				other.elements = nullptr;
+				other.numElements = 0;
+			}
+			return *this;
+		}
+
+		/*! Takes over a table built in process*/
+		void assign(std::vector<ElementType>&& builtElements)
+		{
+			ownedElements = std::move(builtElements);
+			elements = ownedElements.data();
+			numElements = int64(ownedElements.size());
+		}
+		/*! Views elements owned by someone else, they have to outlive the table*/
+		void view(const ElementType* externalElements, int64 numExternalElements)
+		{
+			ownedElements.clear();
+			ownedElements.shrink_to_fit();
+			elements = externalElements;
+			numElements = numExternalElements;
+		}
+		void view(const TTopologyTable& otherTable)
+		{
+			view(otherTable.GetData(), otherTable.Num());
+		}
+		bool ownsElements() const { return elements == ownedElements.data(); }
+		/*! Write access for tables that are built in place, only valid while the table owns its elements*/
+		HEXPLANET_FORCEINLINE ElementType& getMutable(int64 index)
+		{
+			HEXPLANET_CHECK_SLOW(ownsElements());
+			return ownedElements[index];
+		}
+
+		HEXPLANET_FORCEINLINE int64 Num() const { return numElements; }
+		HEXPLANET_FORCEINLINE const ElementType& operator[](int64 index) const
+		{
+			HEXPLANET_CHECK_SLOW(index >= 0 && index < numElements);
+			return elements[index];
+		}
+		HEXPLANET_FORCEINLINE const ElementType* GetData() const { return elements; }
+		HEXPLANET_FORCEINLINE const ElementType* begin() const { return elements; }
+		HEXPLANET_FORCEINLINE const ElementType* end() const { return elements + numElements; }
+
+	private:
+		std::vector<ElementType> ownedElements;
+		const ElementType* elements;
+		int64 numElements;
+	};
+
+	struct FSphereGridTopology;
+
+	/*!
+	* \struct FTileVisitScratch
+	* \brief Reusable visited marks for breadth first searches over the grid
+	* \details Marks are stamped with a search epoch, so starting a new search is
+	* constant time instead of clearing a flag for every tile on the grid
+	*/
+	struct FTileVisitScratch
+	{
+		FTileVisitScratch()
+			: currentEpoch(0)
+		{
+		}
+
+		/*! Starts a new search, forgetting every mark from the previous one*/
+		void beginSearch(int32 numTiles);
+		HEXPLANET_FORCEINLINE bool isVisited(int32 tileIndex) const { return visitEpochs[tileIndex] == currentEpoch; }
+		/*! Marks the tile, returns false if it was already marked during this search*/
+		HEXPLANET_FORCEINLINE bool markVisited(int32 tileIndex)
+		{
+			if (visitEpochs[tileIndex] == currentEpoch)
+			{
+				return false;
+			}
+			visitEpochs[tileIndex] = currentEpoch;
+			return true;
+		}
+
+	private:
+		std::vector<uint32> visitEpochs;
+		uint32 currentEpoch;
+	};
+
+	/*!
+	* \struct FDiskStencilSet
+	* \brief The disk of every tile out to one radius, stored as tile index offsets
+	* \details Away from the seams almost every tile sees the same offsets to the tiles
+	* around it, so each distinct offset pattern is stored once and every tile just
+	* records which pattern describes its disk
+	*/
+	struct FDiskStencilSet
+	{
+		int32 radius;
+		/*! The pattern describing the disk of every tile*/
+		std::vector<int32> tilePatterns;
+		/*! The offsets of pattern p are patternTileOffsets[patternOffsets[p]] up to patternTileOffsets[patternOffsets[p+1]]*/
+		std::vector<int32> patternOffsets;
+		std::vector<int32> patternTileOffsets;
+
+		/*! Writes the disk around centerTile into outTileIndexes, center first and then ring by ring*/
+		void getDisk(const int32& centerTile, std::vector<int32>& outTileIndexes) const;
+		int64 getAllocatedSize() const;
+	};
+
+	/*!
+	* \struct FDiskStencilCacheEntry
+	* \brief A grid's hold on the disk stencils for one radius
+	* \details The stencil sets themselves are shared by every grid with the same topology,
+	* each grid only tracks which ones it keeps alive and when it last used them
+	*/
+	struct FDiskStencilCacheEntry
+	{
+		std::shared_ptr<const FDiskStencilSet> stencilSet;
+		/*! Stamp of the last lookup, used to evict the least recently used radius*/
+		uint64 lastUseStamp;
+	};
+
+	/*!
+	* \struct TIcosahedronFaceBasis
+	* \brief The precomputed non orthogonal basis of one icosahedron face
+	* \details planeNormal is scaled such that a point p on the sphere projects onto
+	* the face at planeR * p / (planeNormal . p)
+	*/
+	template<typename T>
+	struct TIcosahedronFaceBasis
+	{
+		TVector3<T> refPoint;
+		TVector3<T> uDir;
+		TVector3<T> vDir;
+		TVector3<T> planeNormal;
+		T planeR;
+		T uMag;
+		T vMag;
+		T uDotV;
+		T divisor;
+	};
+	typedef TIcosahedronFaceBasis<float> FIcosahedronFaceBasis;
+
+	/*!
+	* \struct FIcosahedronDiamond
+	* \brief A pair of icosahedron faces sharing the u1v11 reference point
+	*/
+	struct FIcosahedronDiamond
+	{
+		int32 uRef1;
+		int32 vRef11;
+		FVector3f ref11;
+		FVector3f ref12;
+		FVector3f ref21;
+		FVector3f ref22;
+		/*! The lower and upper triangle of the diamond*/
+		FIcosahedronFaceBasis faces[2];
+		/*! The same diamond in double precision for the high resolution mapping*/
+		FVector3d ref12Double;
+		FVector3d ref21Double;
+		TIcosahedronFaceBasis<double> facesDouble[2];
+	};
+
+	/*!
+	* \struct FStripUnfolding
+	* \brief One way of laying a strip of the unwrapped grid down next to another
+	* \details a lattice isometry taking the unwrapped position (u, v) to
+	* (uu * u + uv * v + uOffset, vu * u + vv * v + vOffset)
+	*/
+	struct FStripUnfolding
+	{
+		int32 uu;
+		int32 uv;
+		int32 vu;
+		int32 vv;
+		int32 uOffset;
+		int32 vOffset;
+	};
+
+	/*!
+	* \struct FSphereGridSettings
+	* \brief Everything that decides how a grid is built
+	*/
+	struct HEXPLANETCORE_API FSphereGridSettings
+	{
+		FSphereGridSettings();
+
+		int32 gridFrequency;
+		/*! Also keep a double precision copy of every tile's location on the unit sphere*/
+		bool cacheDoublePrecisionLocations;
+		/*! Build the area, edge lengths and corners of every tile's spherical Voronoi cell*/
+		bool cacheDualCellGeometry;
+		/*! Map positions to tiles in double precision, always on above HighResolutionFrequency*/
+		bool highResolutionMapping;
+		/*! Cache the disk around every tile the first time a radius is asked for*/
+		bool cacheDiskStencils;
+		/*! Memory budget in megabytes for the cached disks, the least recently used radius is evicted first*/
+		int32 diskStencilCacheBudgetMB;
+		/*! Number the tiles along a Morton curve inside each icosahedron diamond*/
+		bool renumberTilesForLocality;
+		/*! Map the grid topology read only from a cache file in topologyCacheDirectory, writing it the first time a frequency is built.
+		* Off by default and ignored while topologyCacheDirectory is empty*/
+		bool useTopologyCache;
+		std::string topologyCacheDirectory;
+	};
+
+	/*!
+	* \class FIcosahedralGrid
+	* \brief Building and Navigating the Grid
+	* \details The grid is responsible for building the tiles, computing neighbors,
+	* Manhattan distances between points, and translating between a
+	* spherical location and the corresponding tile.
+	* \note the axial grid coordinate system for the produced grid
+	* is such that u - v + w = 0
+	*/
+	class HEXPLANETCORE_API FIcosahedralGrid
+	{
+	public:
+		FIcosahedralGrid();
+		~FIcosahedralGrid();
+
+		/*! Sets the grid up for the settings, sharing the topology with any other grid built the same way*/
+		void build(const FSphereGridSettings& settings);
+		const FSphereGridSettings& getSettings() const;
+
+		int32 gridFrequency;
+		int32 numNodes;
+		float icosahedronInteriorAngle;
+
+		FGridIndex getPrimaryGridIndex(const int32& tileIndex) const;
+		/*! The number of positions a tile occupies on the grid, more than one only for seam tiles*/
+		int32 getNumGridPositions(const int32& tileIndex) const;
+		FGridIndex getGridIndex(const int32& tileIndex, const int32& positionNum) const;
+		static uint32 packGridIndex(const int32& uLoc, const int32& vLoc);
+		static FGridIndex unpackGridIndex(const uint32& packedIndex);
+
+		int32 mapPosToTileIndex(FVector3f positionOnSphere) const;
+		/*! Maps a position in double precision whether or not the grid is in high resolution mode*/
+		int32 mapPosToTileIndexDouble(FVector3d positionOnSphere) const;
+		/*! Maps a whole batch of positions to tile indexes, several positions at a time where SIMD is available*/
+		void mapPositionsToTileIndexes(const FVector3f* positionsOnSphere, int32* outTileIndexes, int32 numPositions) const;
+		/*! The diamond a unit length position falls in and whether it lies in the diamond's upper triangle*/
+		const FIcosahedronDiamond& selectFaceDiamond(const FVector3f& unitPositionOnSphere, bool& outUpperTriangle) const;
+		const FIcosahedronDiamond& selectFaceDiamond(const FVector3d& unitPositionOnSphere, bool& outUpperTriangle) const;
+
+		FVector3f getNodeLocationOnSphereUV(const int32& uLoc, const int32& vLoc) const;
+		/*! The cached location of a tile on the unit sphere*/
+		FVector3f getTileLocationOnSphere(const int32& tileIndex) const;
+		/*! The cached double precision location of a tile on the unit sphere, only valid if cacheDoublePrecisionLocations was set*/
+		void getTileLocationOnSphereDouble(const int32& tileIndex, double& outX, double& outY, double& outZ) const;
+		/*! The area of a tile's spherical Voronoi cell on the unit sphere, the mean tile area if cacheDualCellGeometry is off*/
+		float getTileCellArea(const int32& tileIndex) const;
+		/*! The unit sphere length of the cell edge a tile shares with its neighbor edgeNum, only valid if cacheDualCellGeometry was set*/
+		float getTileCellEdgeLength(const int32& tileIndex, const int32& edgeNum) const;
+		/*! Corner cornerNum of a tile's cell on the unit sphere, where the tile meets its neighbors cornerNum and cornerNum + 1*/
+		FVector3f getTileCellCorner(const int32& tileIndex, const int32& cornerNum) const;
+
+		/*! The neighbors of a tile in ring order, read straight out of the neighbor table without allocating*/
+		FTileIndexView getTileNeighborView(const int32& tileIndex) const;
+		std::vector<int32> getTileIndexesNStepsAwayFromIndex(const int32& tileIndex, const int32& numSteps) const;
+		/*! The six tiles around a grid position in ring order, directions without a distinct tile hold the lowest int32*/
+		std::vector<int32> getIndexNeighbors(const FGridIndex& gridIndex) const;
+
+		void decrementU(int32 &nextU, int32 &nextV) const;
+		void incrementU(int32 &nextU, int32 &nextV) const;
+		/*! Walks from tile to neighboring tile along the great circle arc between two tiles, both ends included*/
+		void traceGreatCircleBetweenTiles(const int32& startTile, const int32& endTile, std::vector<int32>& outTileIndexes) const;
+		/*! Traces many arcs in parallel, the path of arc i is outPathTiles[outPathOffsets[i]] up to outPathTiles[outPathOffsets[i+1]]*/
+		void traceGreatCirclesBetweenTiles(const int32* startTiles, const int32* endTiles, int32 numPaths,
+			std::vector<int32>& outPathOffsets, std::vector<int32>& outPathTiles) const;
+		/*! Adds every available neighbor of the set to it, marking them unavailable*/
+		void expandTileSet(std::vector<int32>& tileIndexSet, std::vector<bool>& tileAvailability) const;
+		/*! The cached disks for a radius, built on first use, null if the radius is too large to cache, doesn't fit in the budget or is still being built*/
+		std::shared_ptr<const FDiskStencilSet> getDiskStencilSet(const int32& radius) const;
+		void clearDiskStencilCache();
+		/*! Adds the unvisited neighbors of tileIndexSet[frontierStart...] to the set and returns the start of the new frontier*/
+		int32 expandTileFrontier(std::vector<int32>& tileIndexSet, const int32& frontierStart, FTileVisitScratch& visitedTiles) const;
+		/*! Breadth first search out to numSteps using the caller's scratch marks, results are ordered by distance*/
+		void floodTileIndexesNStepsAway(const int32& tileIndex, const int32& numSteps, FTileVisitScratch& visitedTiles, std::vector<int32>& outTileIndexes) const;
+
+		/*! The tile whose center is closest to a direction, mapPosToTileIndex refined by walking to closer neighbors*/
+		int32 findNearestTile(const FVector3f& direction) const;
+		/*! Every tile whose center lies within arcAngle radians of a direction, ordered by the number of steps from the
+		* nearest tile. The search only visits the tiles in the cap and the ring around it */
+		void getTilesWithinAngle(const FVector3f& direction, const float& arcAngle, FTileVisitScratch& visitedTiles, std::vector<int32>& outTileIndexes) const;
+		/*! The numTiles tiles closest to a direction, nearest first, found best first from the nearest tile*/
+		void getNearestTiles(const FVector3f& direction, const int32& numTiles, FTileVisitScratch& visitedTiles, std::vector<int32>& outTileIndexes) const;
+
+		/*! The number of steps on the shortest path between two tiles, computed from their grid positions without searching*/
+		int32 getGridDistance(const int32& tileA, const int32& tileB) const;
+		/*! The angle between two tiles on the unit sphere*/
+		float getGreatCircleDistance(const int32& tileA, const int32& tileB) const;
+		/*! Unit sphere great circle distances between tilesA[i] and tilesB[i], read from the cached tile locations*/
+		void getGreatCircleDistances(const int32* tilesA, const int32* tilesB, float* outDistances, int32 numPairs) const;
+		/*! Unit sphere great circle distances from one tile to each tile in a list*/
+		void getGreatCircleDistancesFromTile(const int32& originTile, const int32* tileIndexes, float* outDistances, int32 numTiles) const;
+
+		/*! The tile uStep and vStep lattice steps from a diamond's u1v11 corner along its u and v edges, every tile
+		* but the two poles is reached from exactly one diamond with both steps in [0, gridFrequency) */
+		int32 getDiamondTile(const int32& diamondIndex, const int32& uStep, const int32& vStep) const;
+		/*! The tile stored at (u, v) in the raw grid*/
+		int32 getRectilinearTile(const int32& uLoc, const int32& vLoc) const;
+		/*! The number of v positions in column u of the raw grid*/
+		int32 getRectilinearColumnLength(const int32& uLoc) const;
+		int32 getNumRectilinearColumns() const;
+
+		/*! The Raw Grid, every column stored back to back in one buffer, column u occupies
+		* rectilinearGridM[rectilinearColumnOffsetsM[u]] up to rectilinearGridM[rectilinearColumnOffsetsM[u+1]] */
+		TTopologyTable<int32> rectilinearGridM;
+		TTopologyTable<int32> rectilinearColumnOffsetsM;
+
+		/*! The primary grid position of every tile packed by packGridIndex*/
+		TTopologyTable<uint32> tilePrimaryPositionsM;
+		/*! The additional grid positions of the tiles that sit on the icosahedron seams, the seam positions of
+		* tile t are seamPositionsM[seamPositionOffsetsM[s]] up to seamPositionsM[seamPositionOffsetsM[s+1]] where s = seamTileSlotsM[t] */
+		std::unordered_map<int32, int32> seamTileSlotsM;
+		TTopologyTable<int32> seamPositionOffsetsM;
+		TTopologyTable<uint32> seamPositionsM;
+
+		/*! The twelve icosahedron vertices by the tile sitting on them*/
+		std::map<int32, FVector3f> gridReferencePointsM;
+
+		/*! Compressed neighbor table, the neighbors of tile t are stored in ring order in
+		* tileNeighborsM[tileNeighborOffsetsM[t]] up to tileNeighborsM[tileNeighborOffsetsM[t+1]]. There are about six
+		* entries per tile, which passes int32 from frequency 5983 on, so the offsets are 64 bit */
+		TTopologyTable<int64> tileNeighborOffsetsM;
+		TTopologyTable<int32> tileNeighborsM;
+
+		/*! The location of every tile on the unit sphere stored as separate coordinate streams*/
+		TTopologyTable<float> tileLocationsXM;
+		TTopologyTable<float> tileLocationsYM;
+		TTopologyTable<float> tileLocationsZM;
+		/*! Double precision copies of the tile locations, empty unless cacheDoublePrecisionLocations is set*/
+		TTopologyTable<double> tileLocationsDoubleXM;
+		TTopologyTable<double> tileLocationsDoubleYM;
+		TTopologyTable<double> tileLocationsDoubleZM;
+		/*! The spherical Voronoi cell of every tile on the unit sphere, empty unless cacheDualCellGeometry is set. The edges
+		* and corners of tile t are stored alongside its neighbors at tileNeighborOffsetsM[t] up to tileNeighborOffsetsM[t+1],
+		* edge i is the one shared with neighbor i and runs from corner i-1 to corner i */
+		TTopologyTable<float> tileCellAreasM;
+		TTopologyTable<float> tileCellEdgeLengthsM;
+		TTopologyTable<FVector3f> tileCellCornersM;
+
+		/*! Packed grid positions hold u and v in 16 bits each*/
+		static const int32 MaxPackedGridFrequency = 13107;
+		/*! Past this frequency single precision rounding in the mapping starts picking neighboring tiles*/
+		static const int32 HighResolutionFrequency = 1000;
+		/*! Hexagons have six neighbors and the pentagons five*/
+		static const int32 MaxTileNeighbors = 6;
+		/*! Disks are only cached out to this radius, a larger disk takes little longer to walk than to copy*/
+		static const int32 MaxDiskStencilRadius = 8;
+		/*! Disks are only cached for radii up to the frequency over this, wider disks cross so many seams that few tiles share a pattern*/
+		static const int32 DiskStencilFrequencyPerRadius = 16;
+		/*! Disk stencils by radius, guarded by diskStencilLockM*/
+		mutable std::unordered_map<int32, FDiskStencilCacheEntry> diskStencilSetsM;
+		/*! Radii whose stencils didn't fit in the budget*/
+		mutable std::unordered_set<int32> uncachedDiskRadiiM;
+		/*! Radii some thread is building the stencils for outside the lock, other queries walk their disks meanwhile*/
+		mutable std::unordered_set<int32> buildingDiskRadiiM;
+		mutable int64 diskStencilBytesM;
+		mutable uint64 diskStencilUseCounterM;
+		mutable std::mutex diskStencilLockM;
+
+		/*! The twelve tiles with only five neighbors*/
+		std::vector<int32> pentagonTileIndexesM;
+		/*! The largest angle between the centers of two neighboring tiles*/
+		float maxNeighborAngleM;
+		/*! The topology the tables above view, shared with every grid of the same frequency and tile numbering*/
+		std::shared_ptr<FSphereGridTopology> topologyM;
+
+		/*! Shortest paths never cross more than this many strip boundaries*/
+		static const int32 MaxStripUnfoldingOffset = 3;
+		/*! The ways a strip s strips along from strip 0 can be laid down next to it, the unfoldings for s are
+		* stripUnfoldingsM[stripUnfoldingOffsetsM[i]] up to stripUnfoldingsM[stripUnfoldingOffsetsM[i+1]] where i = s + MaxStripUnfoldingOffset */
+		std::vector<FStripUnfolding> stripUnfoldingsM;
+		std::vector<int32> stripUnfoldingOffsetsM;
+
+		static const int32 NumFaceSelectionPoints = 10;
+		static const int32 NumIcosahedronDiamonds = 10;
+		/*! The non polar reference points, the closest three of which select the face a position falls on*/
+		FVector3f faceSelectionPointsM[NumFaceSelectionPoints];
+		FVector3d faceSelectionPointsDoubleM[NumFaceSelectionPoints];
+		/*! The diamond selected by every ordering of the three closest face selection points*/
+		int8 faceSelectionTableM[NumFaceSelectionPoints * NumFaceSelectionPoints * NumFaceSelectionPoints];
+		FIcosahedronDiamond diamondsM[NumIcosahedronDiamonds];
+
+	protected:
+		int32& getRectilinearTileRef(const int32& uLoc, const int32& vLoc);
+		void buildGridTopology();
+		uint32 getTopologyLayoutFlags() const;
+		void shareGridTopology(FSphereGridTopology& topology);
+		void viewGridTopology();
+		void buildSeamPositionTable(const std::vector<int32>& seamTiles, const std::vector<uint32>& seamTilePositions);
+		void buildLocalityTileOrder(std::vector<int32>& outNewTileIndexes) const;
+		void renumberTiles(const std::vector<int32>& newTileIndexes);
+		void buildTileNeighborTable();
+		void buildTileLocationTables();
+		void buildDoubleTileLocationTables();
+		/*! Computes the double precision locations into the shared topology, called with its lazyTableLock held*/
+		void fillDoubleTileLocationTables();
+		void buildDualCellTables();
+		/*! Computes the dual cell geometry into the shared topology, called with its lazyTableLock held*/
+		void fillDualCellTables();
+		void measureMaxNeighborAngle();
+		void buildFaceSelectionTables();
+		void buildPentagonTable();
+		void buildStripUnfoldingTable();
+		void getUnfoldedGridPosition(const int32& tileIndex, int32& strip, int32& uPos, int32& vPos) const;
+		void enumerateTileDisk(const int32& tileIndex, const int32& numSteps, std::vector<int32>& outTileIndexes) const;
+		/*! Null as soon as the patterns outgrow budgetBytes*/
+		std::shared_ptr<FDiskStencilSet> buildDiskStencilSet(const int32& radius, const int64& budgetBytes) const;
+		bool isDiskFreeOfPentagons(const int32& centerTile, const int32& numSteps) const;
+		void walkHexDisk(const int32& centerTile, const int32& numSteps, std::vector<int32>& outTileIndexes) const;
+		void stepHexTile(int32& tileIndex, int32& heading) const;
+		template<typename T>
+		void buildFaceBasis(const TVector3<T>& refPoint, const TVector3<T>& uVec, const TVector3<T>& vVec, TIcosahedronFaceBasis<T>& faceBasis) const;
+		template<typename T>
+		const FIcosahedronDiamond& findFaceDiamond(const TVector3<T>* selectionPoints, const TVector3<T>& unitPositionOnSphere, bool& outUpperTriangle) const;
+		template<typename T>
+		int32 mapUnitPosToTileIndex(const TVector3<T>& unitPositionOnSphere) const;
+		void resolveReferenceDiamond(const FGridIndex refPoints[3], int32& uRef1, int32& vRef11) const;
+		void getNodeReferenceFrameUV(const int32& uLoc, const int32& vLoc, FVector3f& refPoint, FVector3f& uSpan, FVector3f& vSpan,
+			int32& localU, int32& localV) const;
+		FVector3f computeNodeLocationOnSphereUV(const int32& uLoc, const int32& vLoc) const;
+		std::vector<int32> mergeTileNeighborIndexes(const int32& tileIndex) const;
+
+		std::vector<FVector3f> createBaseIcosahedron() const;
+
+	private:
+		FIcosahedralGrid(const FIcosahedralGrid&);
+		FIcosahedralGrid& operator=(const FIcosahedralGrid&);
+
+		FSphereGridSettings settingsM;
+	};
+
+	HEXPLANET_FORCEINLINE const FSphereGridSettings& FIcosahedralGrid::getSettings() const
+	{
+		return settingsM;
+	}
+
+	HEXPLANET_FORCEINLINE int32 FIcosahedralGrid::getRectilinearTile(const int32& uLoc, const int32& vLoc) const
+	{
+		HEXPLANET_CHECK_SLOW(vLoc >= 0 && vLoc < getRectilinearColumnLength(uLoc));
+		return rectilinearGridM[rectilinearColumnOffsetsM[uLoc] + vLoc];
+	}
+
+	HEXPLANET_FORCEINLINE int32 FIcosahedralGrid::getDiamondTile(const int32& diamondIndex, const int32& uStep, const int32& vStep) const
+	{
+		//the corner of diamond d sits at ((d / 2) * f, (d % 2 + 1) * f), the columns after it are shifted down by f
+		int32 uLoc = (diamondIndex / 2)*gridFrequency + uStep;
+		if (uLoc >= 5 * gridFrequency)
+		{
+			uLoc -= 5 * gridFrequency;
+		}
+		return getRectilinearTile(uLoc, (diamondIndex % 2 + 1)*gridFrequency + vStep - (uStep > 0 ? gridFrequency : 0));
+	}
+
+	HEXPLANET_FORCEINLINE int32 FIcosahedralGrid::getRectilinearColumnLength(const int32& uLoc) const
+	{
+		return rectilinearColumnOffsetsM[uLoc + 1] - rectilinearColumnOffsetsM[uLoc];
+	}
+
+	HEXPLANET_FORCEINLINE int32 FIcosahedralGrid::getNumRectilinearColumns() const
+	{
+		return int32(rectilinearColumnOffsetsM.Num()) - 1;
+	}
+
+	HEXPLANET_FORCEINLINE int32& FIcosahedralGrid::getRectilinearTileRef(const int32& uLoc, const int32& vLoc)
+	{
+		HEXPLANET_CHECK_SLOW(vLoc >= 0 && vLoc < getRectilinearColumnLength(uLoc));
+		return rectilinearGridM.getMutable(rectilinearColumnOffsetsM[uLoc] + vLoc);
+	}
+
+	HEXPLANET_FORCEINLINE uint32 FIcosahedralGrid::packGridIndex(const int32& uLoc, const int32& vLoc)
+	{
+		return (uint32(uLoc) << 16) | uint32(vLoc);
+	}
+
+	HEXPLANET_FORCEINLINE FGridIndex FIcosahedralGrid::unpackGridIndex(const uint32& packedIndex)
+	{
+		FGridIndex gridIndex;
+		gridIndex.uPos = int32(packedIndex >> 16);
+		gridIndex.vPos = int32(packedIndex & 0xFFFF);
+		return gridIndex;
+	}
+
+	HEXPLANET_FORCEINLINE FGridIndex FIcosahedralGrid::getPrimaryGridIndex(const int32& tileIndex) const
+	{
+		return unpackGridIndex(tilePrimaryPositionsM[tileIndex]);
+	}
+
+	HEXPLANET_FORCEINLINE void FDiskStencilSet::getDisk(const int32& centerTile, std::vector<int32>& outTileIndexes) const
+	{
+		const int32 pattern = tilePatterns[centerTile];
+		const int32 firstOffset = patternOffsets[pattern];
+		const int32 numTiles = patternOffsets[pattern + 1] - firstOffset;
+		outTileIndexes.resize(numTiles);
+		for (int32 diskTile = 0; diskTile < numTiles; ++diskTile)
+		{
+			outTileIndexes[diskTile] = centerTile + patternTileOffsets[firstOffset + diskTile];
+		}
+	}
+
+	HEXPLANET_FORCEINLINE int64 FDiskStencilSet::getAllocatedSize() const
+	{
+		return int64(tilePatterns.size() + patternOffsets.size() + patternTileOffsets.size()) * sizeof(int32);
+	}
+
+	HEXPLANET_FORCEINLINE void FTileVisitScratch::beginSearch(int32 numTiles)
+	{
+		if (int32(visitEpochs.size()) != numTiles || currentEpoch == std::numeric_limits<uint32>::max())
+		{
+			visitEpochs.assign(numTiles, 0);
+			currentEpoch = 0;
+		}
+		++currentEpoch;
+	}
+
+	HEXPLANET_FORCEINLINE FTileIndexView FIcosahedralGrid::getTileNeighborView(const int32& tileIndex) const
+	{
+		const int64 firstNeighbor = tileNeighborOffsetsM[tileIndex];
+		return FTileIndexView(tileNeighborsM.GetData() + firstNeighbor, int32(tileNeighborOffsetsM[tileIndex + 1] - firstNeighbor));
+	}
+
+	HEXPLANET_FORCEINLINE FVector3f FIcosahedralGrid::getTileLocationOnSphere(const int32& tileIndex) const
+	{
+		return FVector3f(tileLocationsXM[tileIndex], tileLocationsYM[tileIndex], tileLocationsZM[tileIndex]);
+	}
+
+	HEXPLANET_FORCEINLINE void FIcosahedralGrid::getTileLocationOnSphereDouble(const int32& tileIndex, double& outX, double& outY, double& outZ) const
+	{
+		outX = tileLocationsDoubleXM[tileIndex];
+		outY = tileLocationsDoubleYM[tileIndex];
+		outZ = tileLocationsDoubleZM[tileIndex];
+	}
+
+	HEXPLANET_FORCEINLINE float FIcosahedralGrid::getTileCellArea(const int32& tileIndex) const
+	{
+		return tileCellAreasM.Num() > 0 ? tileCellAreasM[tileIndex] : 4 * Pi / numNodes;
+	}
+
+	HEXPLANET_FORCEINLINE float FIcosahedralGrid::getTileCellEdgeLength(const int32& tileIndex, const int32& edgeNum) const
+	{
+		HEXPLANET_CHECK_SLOW(edgeNum >= 0 && edgeNum < tileNeighborOffsetsM[tileIndex + 1] - tileNeighborOffsetsM[tileIndex]);
+		return tileCellEdgeLengthsM[tileNeighborOffsetsM[tileIndex] + edgeNum];
+	}
+
+	HEXPLANET_FORCEINLINE FVector3f FIcosahedralGrid::getTileCellCorner(const int32& tileIndex, const int32& cornerNum) const
+	{
+		HEXPLANET_CHECK_SLOW(cornerNum >= 0 && cornerNum < tileNeighborOffsetsM[tileIndex + 1] - tileNeighborOffsetsM[tileIndex]);
+		return tileCellCornersM[tileNeighborOffsetsM[tileIndex] + cornerNum];
+	}
+}
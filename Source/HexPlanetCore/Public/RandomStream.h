@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HexPlanetCoreTypes.h"
+#include <cstring>
+
+namespace HexPlanet
+{
+	/*!
+	* \struct FRandomStream
+	* \brief A seeded linear congruential random number stream
+	* \details Used in place of the global rand() so a seed produces the same planet on every
+	* platform and compiler, and so the simulation and the noise don't disturb each other's sequence.
+	* The ranges follow the engine's FMath helpers
+	*/
+	struct FRandomStream
+	{
+		FRandomStream()
+			: seed(0)
+		{
+		}
+		explicit FRandomStream(int32 inSeed)
+			: seed(uint32(inSeed))
+		{
+		}
+
+		HEXPLANET_FORCEINLINE void initialize(int32 inSeed)
+		{
+			seed = uint32(inSeed);
+		}
+		HEXPLANET_FORCEINLINE uint32 getUnsignedInt()
+		{
+			mutateSeed();
+			return seed;
+		}
+		/*! A float in [0, 1)*/
+		HEXPLANET_FORCEINLINE float getFraction()
+		{
+			mutateSeed();
+			//the top 23 bits of the seed become the mantissa of a float in [1, 2)
+			const uint32 fractionBits = 0x3F800000U | (seed >> 9);
+			float fraction;
+			std::memcpy(&fraction, &fractionBits, sizeof(fraction));
+			return fraction - 1.0f;
+		}
+		/*! An int in [0, maxValue), 0 if maxValue isn't positive*/
+		HEXPLANET_FORCEINLINE int32 randHelper(int32 maxValue)
+		{
+			if (maxValue <= 0)
+			{
+				return 0;
+			}
+			//large ranges can round the product up to maxValue itself
+			const int32 randValue = int32(getFraction() * float(maxValue));
+			return randValue < maxValue ? randValue : maxValue - 1;
+		}
+		/*! An int in [minValue, maxValue]*/
+		HEXPLANET_FORCEINLINE int32 randRange(int32 minValue, int32 maxValue)
+		{
+			return minValue + randHelper(maxValue - minValue + 1);
+		}
+		/*! A float in [minValue, maxValue)*/
+		HEXPLANET_FORCEINLINE float fRandRange(float minValue, float maxValue)
+		{
+			return minValue + (maxValue - minValue) * getFraction();
+		}
+
+	private:
+		HEXPLANET_FORCEINLINE void mutateSeed()
+		{
+			seed = seed * 196314165U + 907633515U;
+		}
+
+		uint32 seed;
+	};
+}
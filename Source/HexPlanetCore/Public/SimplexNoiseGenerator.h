@@ -0,0 +1,62 @@
+/*
+SimplexNoise 1.0.0
+-----
+DevDad - Afan Olovcic @ www.art-and-code.com - 08/12/2015
+
+This algorithm was originally designed by Ken Perlin, but my code has been
+adapted and extended from the implementation written by Stefan Gustavson (stegu@itn.liu.se)
+and modified to fit to Unreal Engine 4
+
+From DevDad and Dedicated to you and Unreal Community
+Use it free for what ever you want
+I only request that you mention me in the credits for your game in the way that feels most appropriate to you.
+
+*/
+
+#pragma once
+
+#include "HexPlanetCoreTypes.h"
+
+namespace HexPlanet
+{
+	/*!
+	* \class FSimplexNoiseGenerator
+	* \brief Perlin simplex noise in one to four dimensions
+	* \details Every generator owns its permutation table, so generators seeded differently
+	* can be used side by side. A new generator starts out with Ken Perlin's reference table
+	*/
+	class HEXPLANETCORE_API FSimplexNoiseGenerator
+	{
+	public:
+		FSimplexNoiseGenerator();
+
+		/*! Rebuilds the permutation table from a seed*/
+		void setNoiseSeed(const int32& newSeed);
+
+		float simplexNoise1D(float x) const;
+		float simplexNoise2D(float x, float y) const;
+		float simplexNoise3D(float x, float y, float z) const;
+		float simplexNoise4D(float x, float y, float z, float w) const;
+
+		// Scaled by float value
+		float simplexNoiseScaled1D(float x, float s) const;
+		float simplexNoiseScaled2D(float x, float y, float s) const;
+		float simplexNoiseScaled3D(float x, float y, float z, float s) const;
+		float simplexNoiseScaled4D(float x, float y, float z, float w, float s) const;
+
+		// Return value in Range between two float numbers
+		// Return Value is scaled by difference between rangeMin & rangeMax value
+		float simplexNoiseInRange1D(float x, float rangeMin, float rangeMax) const;
+		float simplexNoiseInRange2D(float x, float y, float rangeMin, float rangeMax) const;
+		float simplexNoiseInRange3D(float x, float y, float z, float rangeMin, float rangeMax) const;
+		float simplexNoiseInRange4D(float x, float y, float z, float w, float rangeMin, float rangeMax) const;
+
+	private:
+		static float grad(int hash, float x);
+		static float grad(int hash, float x, float y);
+		static float grad(int hash, float x, float y, float z);
+		static float grad(int hash, float x, float y, float z, float t);
+
+		unsigned char perm[512];
+	};
+}
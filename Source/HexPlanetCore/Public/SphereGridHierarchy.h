@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "IcosahedralGrid.h"
+#include <vector>
+
+namespace HexPlanet
+{
+	/*!
+	* \struct FSphereGridLevelLink
+	* \brief Links two grids whose frequencies differ by a factor of 2 or 3
+	* \details Refining the grid subdivides every lattice triangle of the coarse grid, so every
+	* coarse tile sits exactly on a fine tile and every fine tile lies inside a triangle of three
+	* coarse parents. Prolongation interpolates a coarse field with the barycentric weights of those
+	* parents, restriction is its transpose, normalized so a constant field stays constant
+	*/
+	struct HEXPLANETCORE_API FSphereGridLevelLink
+	{
+		FSphereGridLevelLink();
+
+		/*! Builds the links between two built grids, false if the fine frequency isn't 2 or 3 times the coarse one*/
+		bool build(const FIcosahedralGrid& coarseGrid, const FIcosahedralGrid& fineGrid);
+
+		/*! Interpolates a field over the coarse tiles onto the fine tiles*/
+		void prolongateValues(const std::vector<float>& coarseValues, std::vector<float>& outFineValues) const;
+		/*! Averages a field over the fine tiles onto the coarse tiles using the transposed interpolation weights*/
+		void restrictValues(const std::vector<float>& fineValues, std::vector<float>& outCoarseValues) const;
+
+		/*! The fine tile sitting on a coarse tile*/
+		int32 getChildTile(const int32& coarseTile) const;
+		/*! The coarse tiles a fine tile is interpolated from and their weights, unused parents have weight zero*/
+		void getParentTiles(const int32& fineTile, int32 outParentTiles[3], float outParentWeights[3]) const;
+
+		int32 refinementRatio;
+		int32 numCoarseTiles;
+		int32 numFineTiles;
+		/*! Three parents and weights for every fine tile*/
+		std::vector<int32> parentTiles;
+		std::vector<float> parentWeights;
+		/*! The fine tile on every coarse tile*/
+		std::vector<int32> childTiles;
+		/*! The transposed weights, fine tile restrictionTiles[i] contributes restrictionWeights[i] to coarse tile c
+		* for restrictionOffsets[c] <= i < restrictionOffsets[c+1] */
+		std::vector<int32> restrictionOffsets;
+		std::vector<int32> restrictionTiles;
+		std::vector<float> restrictionWeights;
+	};
+
+	HEXPLANET_FORCEINLINE int32 FSphereGridLevelLink::getChildTile(const int32& coarseTile) const
+	{
+		return childTiles[coarseTile];
+	}
+
+	HEXPLANET_FORCEINLINE void FSphereGridLevelLink::getParentTiles(const int32& fineTile, int32 outParentTiles[3], float outParentWeights[3]) const
+	{
+		for (int32 parentNum = 0; parentNum < 3; ++parentNum)
+		{
+			outParentTiles[parentNum] = parentTiles[3 * fineTile + parentNum];
+			outParentWeights[parentNum] = parentWeights[3 * fineTile + parentNum];
+		}
+	}
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "IcosahedralGrid.h"
+#include <vector>
+
+namespace HexPlanet
+{
+	/*!
+	* \struct FTileRange
+	* \brief A run of consecutive tile indexes
+	*/
+	struct FTileRange
+	{
+		int32 firstTile;
+		int32 numTiles;
+	};
+
+	/*!
+	* \struct FSphereGridPartition
+	* \brief Splits the grid into chunks along the ten icosahedron diamonds
+	* \details Every diamond is an f by f parallelogram of tiles on the lattice, it is cut into
+	* chunksPerDiamondSide by chunksPerDiamondSide chunks of equal size. The two polar tiles sit
+	* outside every diamond and join a neighboring chunk. Every tile belongs to exactly one chunk,
+	* the halo of a chunk is the tiles of other chunks within haloWidth steps of it, which is what
+	* a chunk reads but doesn't own when chunks are processed in parallel
+	*/
+	struct HEXPLANETCORE_API FSphereGridPartition
+	{
+		FSphereGridPartition();
+
+		/*! Partitions a built grid, chunksPerDiamondSide is clamped to the grid frequency*/
+		void build(const FIcosahedralGrid& grid, int32 inChunksPerDiamondSide = 1, int32 inHaloWidth = 1);
+
+		int32 getNumChunks() const;
+		int32 getTileChunk(const int32& tileIndex) const;
+		/*! The diamond a chunk was cut from, diamonds are numbered like FIcosahedralGrid::diamondsM*/
+		int32 getChunkDiamond(const int32& chunkIndex) const;
+		/*! The tiles of a chunk in ascending order*/
+		FTileIndexView getChunkTiles(const int32& chunkIndex) const;
+		/*! The tiles of a chunk as runs of consecutive indexes, a handful of runs once the tiles are renumbered for locality*/
+		int32 getNumChunkTileRanges(const int32& chunkIndex) const;
+		const FTileRange& getChunkTileRange(const int32& chunkIndex, const int32& rangeNum) const;
+		/*! The tiles of other chunks within haloWidth steps of the chunk in ascending order*/
+		FTileIndexView getChunkHaloTiles(const int32& chunkIndex) const;
+		/*! The chunks sharing a border with the chunk*/
+		FTileIndexView getNeighborChunks(const int32& chunkIndex) const;
+
+		int32 chunksPerDiamondSide;
+		int32 haloWidth;
+		int32 numChunks;
+		/*! The chunk of every tile*/
+		std::vector<int32> tileChunks;
+		/*! The tiles of chunk c are chunkTiles[chunkTileOffsets[c]] up to chunkTiles[chunkTileOffsets[c+1]], the same
+		* layout is used for the ranges, the halo tiles and the neighboring chunks */
+		std::vector<int32> chunkTileOffsets;
+		std::vector<int32> chunkTiles;
+		std::vector<int32> chunkRangeOffsets;
+		std::vector<FTileRange> chunkTileRanges;
+		std::vector<int32> chunkHaloOffsets;
+		std::vector<int32> chunkHaloTiles;
+		std::vector<int32> chunkNeighborOffsets;
+		std::vector<int32> chunkNeighbors;
+	};
+
+	HEXPLANET_FORCEINLINE int32 FSphereGridPartition::getNumChunks() const
+	{
+		return numChunks;
+	}
+
+	HEXPLANET_FORCEINLINE int32 FSphereGridPartition::getTileChunk(const int32& tileIndex) const
+	{
+		return tileChunks[tileIndex];
+	}
+
+	HEXPLANET_FORCEINLINE int32 FSphereGridPartition::getChunkDiamond(const int32& chunkIndex) const
+	{
+		return chunkIndex / (chunksPerDiamondSide * chunksPerDiamondSide);
+	}
+
+	HEXPLANET_FORCEINLINE FTileIndexView FSphereGridPartition::getChunkTiles(const int32& chunkIndex) const
+	{
+		return FTileIndexView(chunkTiles.data() + chunkTileOffsets[chunkIndex], chunkTileOffsets[chunkIndex + 1] - chunkTileOffsets[chunkIndex]);
+	}
+
+	HEXPLANET_FORCEINLINE int32 FSphereGridPartition::getNumChunkTileRanges(const int32& chunkIndex) const
+	{
+		return chunkRangeOffsets[chunkIndex + 1] - chunkRangeOffsets[chunkIndex];
+	}
+
+	HEXPLANET_FORCEINLINE const FTileRange& FSphereGridPartition::getChunkTileRange(const int32& chunkIndex, const int32& rangeNum) const
+	{
+		HEXPLANET_CHECK_SLOW(rangeNum >= 0 && rangeNum < getNumChunkTileRanges(chunkIndex));
+		return chunkTileRanges[chunkRangeOffsets[chunkIndex] + rangeNum];
+	}
+
+	HEXPLANET_FORCEINLINE FTileIndexView FSphereGridPartition::getChunkHaloTiles(const int32& chunkIndex) const
+	{
+		return FTileIndexView(chunkHaloTiles.data() + chunkHaloOffsets[chunkIndex], chunkHaloOffsets[chunkIndex + 1] - chunkHaloOffsets[chunkIndex]);
+	}
+
+	HEXPLANET_FORCEINLINE FTileIndexView FSphereGridPartition::getNeighborChunks(const int32& chunkIndex) const
+	{
+		return FTileIndexView(chunkNeighbors.data() + chunkNeighborOffsets[chunkIndex], chunkNeighborOffsets[chunkIndex + 1] - chunkNeighborOffsets[chunkIndex]);
+	}
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "IcosahedralGrid.h"
+
+namespace HexPlanet
+{
+	class FSphereGridTopologyCache;
+
+	/*!
+	* \struct FSphereGridTopology
+	* \brief The tables of a grid that only depend on its frequency and how its tiles are numbered
+	* \details Every FIcosahedralGrid with the same frequency and numbering views a single topology, which
+	* lives for as long as any of those grids holds it. The tables are either built by the first grid
+	* or view a mapped topology cache file, later grids just point at them
+	*/
+	struct HEXPLANETCORE_API FSphereGridTopology
+	{
+		FSphereGridTopology(int32 inGridFrequency, uint32 inLayoutFlags);
+		~FSphereGridTopology();
+
+		/*! Views the tables in the cache file for this frequency and numbering, false if there's no usable file*/
+		bool loadCache(const std::string& cacheDirectory);
+		/*! Writes the tables to the cache file, failing to write only means the next run builds them again*/
+		bool saveCache(const std::string& cacheDirectory) const;
+
+		/*! The disk stencils some grid sharing this topology built for a radius and still holds, null otherwise*/
+		std::shared_ptr<const FDiskStencilSet> findDiskStencilSet(const int32& radius) const;
+		/*! Offers newly built stencils to the other grids, returns the stencils that are shared for the radius*/
+		std::shared_ptr<const FDiskStencilSet> shareDiskStencilSet(const std::shared_ptr<const FDiskStencilSet>& diskStencils);
+
+		const int32 gridFrequency;
+		const uint32 layoutFlags;
+		const int32 numNodes;
+
+		TTopologyTable<int32> rectilinearGrid;
+		TTopologyTable<int32> rectilinearColumnOffsets;
+		TTopologyTable<uint32> tilePrimaryPositions;
+		std::unordered_map<int32, int32> seamTileSlots;
+		TTopologyTable<int32> seamPositionOffsets;
+		TTopologyTable<uint32> seamPositions;
+		std::map<int32, FVector3f> gridReferencePoints;
+		TTopologyTable<int64> tileNeighborOffsets;
+		TTopologyTable<int32> tileNeighbors;
+		TTopologyTable<float> tileLocationsX;
+		TTopologyTable<float> tileLocationsY;
+		TTopologyTable<float> tileLocationsZ;
+		/*! Built by the first grid that asks for double precision locations, empty until then*/
+		TTopologyTable<double> tileLocationsDoubleX;
+		TTopologyTable<double> tileLocationsDoubleY;
+		TTopologyTable<double> tileLocationsDoubleZ;
+		/*! Built by the first grid that asks for the dual cell geometry, empty until then*/
+		TTopologyTable<float> tileCellAreas;
+		TTopologyTable<float> tileCellEdgeLengths;
+		TTopologyTable<FVector3f> tileCellCorners;
+		float maxNeighborAngle;
+		/*! Held while a grid checks for and fills the tables built on demand, grids of the frequency may be built concurrently*/
+		std::mutex lazyTableLock;
+
+	private:
+		FSphereGridTopology(const FSphereGridTopology&);
+		FSphereGridTopology& operator=(const FSphereGridTopology&);
+
+		/*! The mapped cache the tables view, null when they were built in process*/
+		std::shared_ptr<FSphereGridTopologyCache> topologyCache;
+		/*! Weak so a radius goes away once no grid keeps it in its own stencil cache*/
+		mutable std::unordered_map<int32, std::weak_ptr<const FDiskStencilSet>> diskStencilSets;
+		mutable std::mutex diskStencilLock;
+	};
+
+	/*!
+	* \class FSphereGridTopologyRegistry
+	* \brief Hands out the shared topology for a frequency and tile numbering
+	* \details The registry only holds weak references, the grids using a topology keep it alive
+	* and it is freed with the last of them
+	*/
+	class HEXPLANETCORE_API FSphereGridTopologyRegistry
+	{
+	public:
+		/*! The topology grids with this frequency and numbering are using, null if there is none*/
+		static std::shared_ptr<FSphereGridTopology> findTopology(int32 gridFrequency, uint32 layoutFlags);
+		/*! Registers a new topology, returns the one already registered instead if another grid got there first*/
+		static std::shared_ptr<FSphereGridTopology> registerTopology(const std::shared_ptr<FSphereGridTopology>& topology);
+		/*! The number of topologies currently in use*/
+		static int32 getNumTopologies();
+
+	private:
+		static uint64 getTopologyKey(int32 gridFrequency, uint32 layoutFlags);
+		static std::unordered_map<uint64, std::weak_ptr<FSphereGridTopology>>& getTopologies();
+		static std::mutex& getRegistryLock();
+	};
+}
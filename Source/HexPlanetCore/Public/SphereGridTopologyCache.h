@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HexPlanetCoreTypes.h"
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace HexPlanet
+{
+	/*! The tables stored in a topology cache file, in the order they are laid out*/
+	namespace ESphereGridTopologySection
+	{
+		enum Type
+		{
+			RectilinearColumnOffsets,
+			RectilinearGrid,
+			TilePrimaryPositions,
+			/*! The seam tiles ordered by their slot in the seam position table*/
+			SeamTiles,
+			SeamPositionOffsets,
+			SeamPositions,
+			TileNeighborOffsets,
+			TileNeighbors,
+			TileLocationsX,
+			TileLocationsY,
+			TileLocationsZ,
+			/*! The reference point tiles and their locations as x, y, z triples*/
+			ReferenceTiles,
+			ReferencePoints,
+			Num
+		};
+	}
+
+	/*!
+	* \struct FSphereGridTopologyHeader
+	* \brief The fixed size header at the start of a topology cache file
+	* \details Every section starts on a cache line boundary, its offset and size are in bytes
+	* from the start of the file
+	*/
+	struct FSphereGridTopologyHeader
+	{
+		uint32 magic;
+		uint32 version;
+		int32 gridFrequency;
+		uint32 layoutFlags;
+		int32 numNodes;
+		float maxNeighborAngle;
+		int64 fileSize;
+		int64 sectionOffsets[ESphereGridTopologySection::Num];
+		int64 sectionSizes[ESphereGridTopologySection::Num];
+	};
+
+	/*!
+	* \class FSphereGridTopologyCache
+	* \brief A topology cache file mapped read only into memory
+	* \details The tables of a grid only depend on its frequency and how its tiles are numbered,
+	* so they are written once to a flat file and every later run maps that file instead of rebuilding them.
+	* Mapped pages are shared by every process that maps the same file. Platforms without file mapping
+	* read the file into memory instead
+	*/
+	class HEXPLANETCORE_API FSphereGridTopologyCache
+	{
+	public:
+		static const uint32 FileMagic = 0x54475848;
+		/*! Bump whenever the layout of the file or the way the grid is built changes*/
+		static const uint32 FileVersion = 3;
+		/*! Set in the layout flags when the tiles are renumbered for locality*/
+		static const uint32 RenumberedTilesFlag = 1;
+		static const int64 SectionAlignment = 64;
+
+		FSphereGridTopologyCache();
+		~FSphereGridTopologyCache();
+
+		/*! Where the cache for a frequency and tile numbering lives inside a cache directory*/
+		static std::string getCacheFilePath(const std::string& cacheDirectory, int32 gridFrequency, uint32 layoutFlags);
+
+		/*! Maps a cache file, false if it is missing, damaged or was written for another version, frequency or numbering*/
+		bool open(const std::string& filePath, int32 gridFrequency, uint32 layoutFlags);
+		void close();
+		bool isOpen() const;
+		/*! Whether the file is mapped rather than read into memory*/
+		bool isMapped() const;
+		const FSphereGridTopologyHeader& getHeader() const;
+
+		/*! The elements of a section, false if it doesn't hold expectedNumElements of them, IndexNone accepts any number*/
+		template<typename ElementType>
+		bool getSection(ESphereGridTopologySection::Type section, int64 expectedNumElements, const ElementType*& outElements, int64& outNumElements) const;
+
+	private:
+		FSphereGridTopologyCache(const FSphereGridTopologyCache&);
+		FSphereGridTopologyCache& operator=(const FSphereGridTopologyCache&);
+
+		bool mapFile(const std::string& filePath);
+		void unmapFile();
+
+		const uint8* fileData;
+		int64 fileSize;
+		/*! The mapped view of the file, null if the file was read into loadedFileData instead*/
+		void* mappedView;
+		std::vector<uint8> loadedFileData;
+	};
+
+	/*!
+	* \class FSphereGridTopologyCacheWriter
+	* \brief Lays the topology tables of a grid out as a cache file
+	* \details Sections are streamed straight from the tables they are added from, which have to
+	* stay alive until the file is written
+	*/
+	class HEXPLANETCORE_API FSphereGridTopologyCacheWriter
+	{
+	public:
+		FSphereGridTopologyCacheWriter(int32 gridFrequency, uint32 layoutFlags, int32 numNodes, float maxNeighborAngle);
+
+		template<typename ElementType>
+		void addSection(ESphereGridTopologySection::Type section, const ElementType* elements, int64 numElements);
+
+		/*! Writes the file next to filePath and then moves it into place, so no process ever maps a partly written cache*/
+		bool write(const std::string& filePath);
+
+	private:
+		void addSectionBytes(ESphereGridTopologySection::Type section, const void* sectionBytes, int64 sectionSize);
+
+		FSphereGridTopologyHeader header;
+		const void* sectionData[ESphereGridTopologySection::Num];
+	};
+
+	HEXPLANET_FORCEINLINE bool FSphereGridTopologyCache::isOpen() const
+	{
+		return fileData != nullptr;
+	}
+
+	HEXPLANET_FORCEINLINE bool FSphereGridTopologyCache::isMapped() const
+	{
+		return mappedView != nullptr;
+	}
+
+	HEXPLANET_FORCEINLINE const FSphereGridTopologyHeader& FSphereGridTopologyCache::getHeader() const
+	{
+		HEXPLANET_CHECK_SLOW(isOpen());
+		return *reinterpret_cast<const FSphereGridTopologyHeader*>(fileData);
+	}
+
+	template<typename ElementType>
+	bool FSphereGridTopologyCache::getSection(ESphereGridTopologySection::Type section, int64 expectedNumElements,
+		const ElementType*& outElements, int64& outNumElements) const
+	{
+		const FSphereGridTopologyHeader& header = getHeader();
+		const int64 sectionSize = header.sectionSizes[section];
+		if (sectionSize % sizeof(ElementType) != 0)
+		{
+			return false;
+		}
+		outNumElements = int64(sectionSize / sizeof(ElementType));
+		if (expectedNumElements != IndexNone && outNumElements != expectedNumElements)
+		{
+			return false;
+		}
+		outElements = reinterpret_cast<const ElementType*>(fileData + header.sectionOffsets[section]);
+		return true;
+	}
+
+	template<typename ElementType>
+	void FSphereGridTopologyCacheWriter::addSection(ESphereGridTopologySection::Type section, const ElementType* elements, int64 numElements)
+	{
+		addSectionBytes(section, elements, numElements * int64(sizeof(ElementType)));
+	}
+}
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CrustCellStore.h"
+#include "HexPlanetParallel.h"
+#include "IcosahedralGrid.h"
+#include "RandomStream.h"
+#include "SimplexNoiseGenerator.h"
+
+namespace HexPlanet
+{
+	/*!
+	* \struct FTectonicPlate
+	* \brief A plate and the crust cells it owns
+	*/
+	struct FTectonicPlate
+	{
+		FTectonicPlate()
+			: plateIndex(IndexNone), currentVelocity(0.0f, 0.0f, 0.0f), centerOfMassIndex(IndexNone),
+			plateTotalMass(0.0f), plateBoundingRadius(0.0f)
+		{
+		}
+
+		//The index of this plate
+		int32 plateIndex;
+		//The crust cells that this plate owns
+		std::vector<int32> ownedCrustCells;
+		//velocities in spherical coordinates and about the axis through the plate center of mass
+		FVector3f currentVelocity;
+		//crust cell about which the plate is centered
+		int32 centerOfMassIndex;
+		//plate total mass
+		float plateTotalMass;
+		//the maximum arc distance on the plate from its center
+		//this is used to quickly determine which other plates it might overlap
+		float plateBoundingRadius;
+	};
+
+	/*! What happens when a crust cell moves onto a tile another cell has already settled on*/
+	namespace ECrustArrival
+	{
+		enum Type
+		{
+			/*! It settled on the tile or merged with crust of its own plate*/
+			Settled,
+			/*! It or the settled cell went under the other*/
+			Subducted,
+			/*! Two continents met and the heavier plate kept the tile*/
+			Collided
+		};
+	}
+
+	/*!
+	* \struct FTectonicSimulationSettings
+	* \brief The parameters of the initial height map, the plate generation and the simulation
+	*/
+	struct HEXPLANETCORE_API FTectonicSimulationSettings
+	{
+		FTectonicSimulationSettings();
+
+		int32 heightMapSeed;
+		int32 numOctaves;
+		float percentOcean;
+		float percentContinentalCrust;
+		/*! The roughness of the initial oceanic crust*/
+		float oceanicCrustRoughnessFactor;
+		/*! The roughness of the initial continental crust*/
+		float continentalCrustFactorRoughness;
+		/*! Overwritten by generateInitialHeightMap with the height continental crust starts at*/
+		float baseContinentalHeight;
+
+		int32 plateSeed;
+		int32 numBasePlates;
+		int32 numBaseSubplates;
+		int32 addSubplatesAfterNSteps;
+		float percentTilesForShapeReseed;
+		float percentTilesForBorderReseed;
+		bool stopAfterFirstPlate;
+
+		float lithosphereDensity; //Gg/m^3
+		float oceanicCrustDensity; //Gg/m^3
+		float continentalCrustDensity; //Gg/m^3
+		float oceanicWaterDensity; //Gg/m^3
+
+		int32 plateDirectionSeed;
+		/*! The maximum amount of material that can be removed from a cell as a percentage of sea level*/
+		float maxErrosionAmount;
+		/*! The height at which errosion is cut off as a percentage of sea level*/
+		float errosionHeightCutoff;
+		int32 radiusAboutCollisionCellToDistributeCrust;
+		/*! The amount of crust to be transfered during a collision*/
+		float foldingRatio;
+	};
+
+	/*!
+	* \class FTectonicSimulation
+	* \brief Generates the initial crust of a planet, splits it into plates and moves them
+	* \details The simulation runs on a built FIcosahedralGrid which has to outlive it. Every
+	* random choice is drawn from streams seeded by the settings, so the same settings and
+	* grid produce the same planet on every machine
+	*/
+	class HEXPLANETCORE_API FTectonicSimulation
+	{
+	public:
+		FTectonicSimulation();
+
+		/*! The grid the crust lives on and the radius of the planet's base mesh*/
+		void setPlanet(const FIcosahedralGrid* inGrid, float inPlanetRadius);
+		const FIcosahedralGrid* getGrid() const;
+		float getPlanetRadius() const;
+
+		/*! Fills crustCells from octaves of simplex noise, optionally noting which cells started as continental crust*/
+		void generateInitialHeightMap(std::vector<bool>* outContinentalCells = nullptr);
+		FCrustCell createBaseCrustCell(const int32& cellIndex, const float& cellHeight) const;
+
+		void buildTectonicPlates();
+		FTectonicPlate createTectonicPlate(const int32& plateIndex, const std::vector<int32>& plateCellIndexes);
+		/*! The mass weighted center of the plate's crust, not projected onto the sphere*/
+		FVector3f computePlateCenterOfMass(const FTectonicPlate& plate, float& outTotalMass) const;
+		void updatePlateCenterOfMass(FTectonicPlate &newPlate) const;
+		void updatePlateBoundingRadius(FTectonicPlate& newPlate) const;
+		/*! Whether the bounding caps of two plates intersect, when they don't no cell of one plate can reach the other*/
+		bool mightPlatesOverlap(const int32& plateA, const int32& plateB) const;
+
+		void initializePlateDirections();
+		/*! Erodes one cell onto its lower neighbors straight away*/
+		void erodeCell(FCrustCell& targetCell);
+		/*! Erodes every cell at once in parallel, each cell erodes from the heights before the pass*/
+		void erodeCells();
+		void updateCrustCellHeight(FCrustCell& crustCell) const;
+		/*! The height crust of a given thickness and density floats at, cellHeight only tells whether it starts under water*/
+		float computeCellHeight(const float& cellHeight, const float& crustThickness, const float& crustDensity) const;
+		/*! Brings the given cells of crustCells to the height computeCellHeight gives them, a batch at a time, no cell may be listed twice*/
+		void relevelCrustCells(const int32* cellIndexes, const int32& numCells);
+		/*! Notes that the crust of a cell changed without its height being updated, a cell is only noted once until the next relevel*/
+		void markCellDirty(const int32& cellIndex);
+		/*! Relevels every cell marked dirty since the last call in one batch*/
+		void relevelDirtyCells();
+		void updateCellLocation(FCrustCell& cellToUpdate);
+		/*! The rotation that carries a plate's cells through one step, its spin about its center followed by the move of its center*/
+		FMatrix3f computePlateMotion(const FTectonicPlate& plate) const;
+		/*! Erodes and moves every cell and resolves the collisions, returns whether there were any continental collisions*/
+		bool executeTimeStep();
+		void transferCrustFromTargetCellToExistingCell(FCrustCell &existingCrust, const FCrustCell &targetCell, float percentCrustTransfer) const;
+		void applyForceToPlate(FTectonicPlate& targetPlate, const int32& forceLocationIndex, const FVector2f& sphericalForce) const;
+		void buildNewCrustFromPlateDivergence(const int32& locationIndex, FCrustCellStore& newCrustData) const;
+		/*! Adds crust to the cells of the plate around a collision, the cells are marked dirty rather than releveled*/
+		bool scatterMassOverArea(FTectonicPlate& targetPlate, std::vector<int32> potentialLocations, const FCrustCell& collisionLocation, float transferRatio);
+
+		FTectonicSimulationSettings settings;
+		/*! The crust on every tile, cell i sits on tile i*/
+		FCrustCellStore crustCells;
+		std::vector<FTectonicPlate> currentPlates;
+		int32 simulationTimeStep;
+
+	protected:
+		void addNewSeedSetsToSetArray(std::vector<bool> &usedTiles, std::vector<std::vector<int32>> &plateSets, const int32& numNewSets);
+		int32 getNextAvailableSeedTile(std::vector<bool> &usedTiles, std::vector<std::vector<int32>> & plateSets);
+		void createVoronoiDiagramFromSeedSets(std::vector<std::vector<int32>>& seedSets, std::vector<bool>& tileAvailability, const int32& maxNumIterations = -1) const;
+		void rebuildTectonicPlates(std::vector<std::vector<int32>>& plateSets, const float& percentTilesForReseed);
+		/*! Fills plateMotionsM for the current plate velocities*/
+		void updatePlateMotions();
+		/*! Where the plate motion carries the crust on a tile, also noting the move in spherical coordinates*/
+		FVector3f computeAdvectedCellPosition(const int32& tileIndex, const FMatrix3f& plateMotion, FVector2f& outCellVelocity) const;
+		/*! Settles a cell landing on a tile already held by settledCell, the cell pushed off the tile is copied to outDisplacedCell*/
+		ECrustArrival::Type settleArrivingCell(FCrustCell& settledCell, const FCrustCell& arrivingCell, FCrustCell& outDisplacedCell) const;
+		/*! What a cell of the given height sheds onto each of its neighbors, returns the number of lower neighbors*/
+		int32 computeErosionInflows(const float& cellHeight, const float* neighborHeights, const int32& numNeighbors, float* outInflows) const;
+
+	private:
+		const FIcosahedralGrid* gridM;
+		float planetRadiusM;
+		/*! Seeded with the height map seed, also drives how collisions scatter crust*/
+		FSimplexNoiseGenerator noiseM;
+		/*! Reseeded for the plate layout and again for the plate directions*/
+		FRandomStream plateRandomM;
+		/*! The heights at the start of the erosion pass and what every cell sheds onto each slot of its neighbor ring*/
+		std::vector<float> erosionHeightsM;
+		std::vector<float> erosionInflowsM;
+		/*! Every chunk of the erosion pass lists the cells it relevels in its own part of this*/
+		std::vector<int32> erodedCellsM;
+		/*! The cells waiting for relevelDirtyCells and a flag per cell for whether it is already listed*/
+		std::vector<int32> dirtyCellsM;
+		std::vector<uint8> dirtyCellFlagsM;
+		/*! The motion of every plate through the current step*/
+		std::vector<FMatrix3f> plateMotionsM;
+		/*! The move phase works in these between steps so a step doesn't allocate, newCrustCellsM is the back buffer crustCells swaps with*/
+		std::vector<FVector3f> advectedPositionsM;
+		std::vector<FAtomicCounter> arrivalCountsM;
+		std::vector<int32> arrivalOffsetsM;
+		std::vector<int32> arrivingCellsM;
+		std::vector<uint8> arrivalOutcomesM;
+		std::vector<FCrustCell> displacedCellsM;
+		std::vector<FCrustCell> subductionsM;
+		std::vector<FCrustCell> collisionsM;
+		FCrustCellStore newCrustCellsM;
+	};
+
+	HEXPLANET_FORCEINLINE const FIcosahedralGrid* FTectonicSimulation::getGrid() const
+	{
+		return gridM;
+	}
+
+	HEXPLANET_FORCEINLINE float FTectonicSimulation::getPlanetRadius() const
+	{
+		return planetRadiusM;
+	}
+}
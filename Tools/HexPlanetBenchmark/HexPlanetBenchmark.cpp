@@ -0,0 +1,473 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Microbenchmarks for the grid primitives. Every benchmark runs on fixed random inputs at each
+// grid frequency and reports the time, the heap allocations and the bytes of query input and
+// results per operation. The results can be written as json to track regressions between builds
+
+#include "IcosahedralGrid.h"
+#include "RandomStream.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace HexPlanet;
+
+//the hooks stay out of line so the compiler never sees malloc and free inside the replaced operators
+#if defined(_MSC_VER)
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif
+
+namespace
+{
+	std::atomic<uint64> numAllocations(0);
+	std::atomic<uint64> numAllocatedBytes(0);
+
+	/*! Counts and makes every heap allocation of the benchmark, null if the heap is out of memory*/
+	BENCHMARK_NOINLINE void* allocateCounted(std::size_t numBytes) noexcept
+	{
+		numAllocations.fetch_add(1, std::memory_order_relaxed);
+		numAllocatedBytes.fetch_add(numBytes, std::memory_order_relaxed);
+		return std::malloc(numBytes != 0 ? numBytes : 1);
+	}
+
+	BENCHMARK_NOINLINE void freeCounted(void* allocation) noexcept
+	{
+		std::free(allocation);
+	}
+
+	void* allocateCountedOrThrow(std::size_t numBytes)
+	{
+		if (void* allocation = allocateCounted(numBytes))
+		{
+			return allocation;
+		}
+		throw std::bad_alloc();
+	}
+}
+
+// every heap allocation made while a benchmark runs is counted here, all the forms go through the same hooks
+void* operator new(std::size_t numBytes)
+{
+	return allocateCountedOrThrow(numBytes);
+}
+
+void* operator new[](std::size_t numBytes)
+{
+	return allocateCountedOrThrow(numBytes);
+}
+
+void* operator new(std::size_t numBytes, const std::nothrow_t&) noexcept
+{
+	return allocateCounted(numBytes);
+}
+
+void* operator new[](std::size_t numBytes, const std::nothrow_t&) noexcept
+{
+	return allocateCounted(numBytes);
+}
+
+void operator delete(void* allocation) noexcept
+{
+	freeCounted(allocation);
+}
+
+void operator delete[](void* allocation) noexcept
+{
+	freeCounted(allocation);
+}
+
+void operator delete(void* allocation, std::size_t) noexcept
+{
+	freeCounted(allocation);
+}
+
+void operator delete[](void* allocation, std::size_t) noexcept
+{
+	freeCounted(allocation);
+}
+
+void operator delete(void* allocation, const std::nothrow_t&) noexcept
+{
+	freeCounted(allocation);
+}
+
+void operator delete[](void* allocation, const std::nothrow_t&) noexcept
+{
+	freeCounted(allocation);
+}
+
+namespace
+{
+	const int32 NumBenchmarkInputs = 1 << 16;
+	const int32 NumRepetitions = 5;
+
+	/*! Runs numOps operations on the prepared inputs and returns the bytes of input and results they streamed*/
+	typedef std::function<uint64(int32 numOps)> FBenchmarkBody;
+
+	struct FBenchmarkResult
+	{
+		std::string benchmarkName;
+		int32 gridFrequency;
+		int32 numTiles;
+		uint64 numOps;
+		double nsPerOp;
+		double allocsPerOp;
+		double allocatedBytesPerOp;
+		double bytesTouchedPerOp;
+	};
+
+	struct FBenchmarkOptions
+	{
+		FBenchmarkOptions()
+			: minRepetitionTimeMs(200.0), inputSeed(12345)
+		{
+			gridFrequencies.push_back(10);
+			gridFrequencies.push_back(100);
+			gridFrequencies.push_back(500);
+		}
+
+		std::vector<int32> gridFrequencies;
+		double minRepetitionTimeMs;
+		int32 inputSeed;
+		std::string filter;
+		std::string outputFile;
+	};
+
+	/*!
+	* Times the body in repetitions of at least the minimum time and keeps the median repetition.
+	* opsPerCall is the number of operations one call of the body with numOps = 1 stands for
+	*/
+	FBenchmarkResult runBenchmark(const std::string& benchmarkName, const FIcosahedralGrid& grid, const FBenchmarkOptions& options,
+		const FBenchmarkBody& body, uint64 opsPerCall = 1)
+	{
+		typedef std::chrono::steady_clock FClock;
+		//warm up and find how many operations fill the repetition time
+		int32 numCalls = 1;
+		for (;;)
+		{
+			const FClock::time_point startTime = FClock::now();
+			body(numCalls);
+			const double elapsedMs = std::chrono::duration<double, std::milli>(FClock::now() - startTime).count();
+			if (elapsedMs >= options.minRepetitionTimeMs || numCalls >= (1 << 28))
+			{
+				break;
+			}
+			const double growth = elapsedMs > 0.0 ? options.minRepetitionTimeMs / elapsedMs * 1.2 : 10.0;
+			numCalls = int32(std::min<double>(double(numCalls) * std::min(std::max(growth, 2.0), 10.0), double(1 << 28)));
+		}
+
+		std::vector<double> repetitionNs;
+		uint64 allocations = 0;
+		uint64 allocatedBytes = 0;
+		uint64 bytesTouched = 0;
+		for (int32 repetition = 0; repetition < NumRepetitions; ++repetition)
+		{
+			const uint64 startAllocations = numAllocations.load();
+			const uint64 startAllocatedBytes = numAllocatedBytes.load();
+			const FClock::time_point startTime = FClock::now();
+			bytesTouched += body(numCalls);
+			repetitionNs.push_back(std::chrono::duration<double, std::nano>(FClock::now() - startTime).count());
+			allocations += numAllocations.load() - startAllocations;
+			allocatedBytes += numAllocatedBytes.load() - startAllocatedBytes;
+		}
+		std::sort(repetitionNs.begin(), repetitionNs.end());
+
+		const uint64 opsPerRepetition = uint64(numCalls) * opsPerCall;
+		const double totalOps = double(opsPerRepetition) * NumRepetitions;
+		FBenchmarkResult result;
+		result.benchmarkName = benchmarkName;
+		result.gridFrequency = grid.gridFrequency;
+		result.numTiles = grid.numNodes;
+		result.numOps = opsPerRepetition;
+		result.nsPerOp = repetitionNs[NumRepetitions / 2] / double(opsPerRepetition);
+		result.allocsPerOp = double(allocations) / totalOps;
+		result.allocatedBytesPerOp = double(allocatedBytes) / totalOps;
+		result.bytesTouchedPerOp = double(bytesTouched) / totalOps;
+		return result;
+	}
+
+	void runGridBenchmarks(const FIcosahedralGrid& grid, const FBenchmarkOptions& options, std::vector<FBenchmarkResult>& outResults)
+	{
+		FRandomStream inputStream(options.inputSeed);
+		//random directions, not normalized, like the positions handed in by the simulation
+		std::vector<FVector3f> randomPositions(NumBenchmarkInputs);
+		for (FVector3f& position : randomPositions)
+		{
+			do
+			{
+				position = FVector3f(inputStream.fRandRange(-1.0f, 1.0f), inputStream.fRandRange(-1.0f, 1.0f), inputStream.fRandRange(-1.0f, 1.0f));
+			} while (position.sizeSquared() < 0.01f || position.sizeSquared() > 1.0f);
+		}
+		std::vector<int32> randomTiles(NumBenchmarkInputs);
+		std::vector<FGridIndex> randomGridIndexes(NumBenchmarkInputs);
+		for (int32 inputNum = 0; inputNum < NumBenchmarkInputs; ++inputNum)
+		{
+			randomTiles[inputNum] = inputStream.randRange(0, grid.numNodes - 1);
+			randomGridIndexes[inputNum] = grid.getPrimaryGridIndex(randomTiles[inputNum]);
+		}
+		//keeps the optimizer from dropping the queries
+		volatile int64 resultSink = 0;
+
+		auto addResult = [&](const FBenchmarkResult& result)
+		{
+			outResults.push_back(result);
+			std::printf("%-36s %6d %10.1f %10.3f %12.1f %10.1f\n", result.benchmarkName.c_str(), result.gridFrequency,
+				result.nsPerOp, result.allocsPerOp, result.allocatedBytesPerOp, result.bytesTouchedPerOp);
+			std::fflush(stdout);
+		};
+		auto isSelected = [&](const std::string& benchmarkName)
+		{
+			return options.filter.empty() || benchmarkName.find(options.filter) != std::string::npos;
+		};
+
+		if (isSelected("mapPosToTileIndex"))
+		{
+			addResult(runBenchmark("mapPosToTileIndex", grid, options, [&](int32 numOps)
+			{
+				int64 tileSum = 0;
+				for (int32 opNum = 0; opNum < numOps; ++opNum)
+				{
+					tileSum += grid.mapPosToTileIndex(randomPositions[opNum & (NumBenchmarkInputs - 1)]);
+				}
+				resultSink = resultSink + tileSum;
+				return uint64(numOps) * (sizeof(FVector3f) + sizeof(int32));
+			}));
+		}
+
+		if (isSelected("mapPositionsToTileIndexes"))
+		{
+			//one call maps a batch of 1024 positions, reported per position
+			const int32 batchSize = 1024;
+			std::vector<int32> batchTiles(batchSize);
+			addResult(runBenchmark("mapPositionsToTileIndexes", grid, options, [&](int32 numOps)
+			{
+				for (int32 opNum = 0; opNum < numOps; ++opNum)
+				{
+					const int32 batchStart = (opNum * batchSize) & (NumBenchmarkInputs - 1);
+					grid.mapPositionsToTileIndexes(&randomPositions[batchStart], batchTiles.data(), batchSize);
+				}
+				resultSink = resultSink + batchTiles[0];
+				return uint64(numOps) * batchSize * (sizeof(FVector3f) + sizeof(int32));
+			}, batchSize));
+		}
+
+		if (isSelected("getNodeLocationOnSphereUV"))
+		{
+			addResult(runBenchmark("getNodeLocationOnSphereUV", grid, options, [&](int32 numOps)
+			{
+				float coordinateSum = 0.0f;
+				for (int32 opNum = 0; opNum < numOps; ++opNum)
+				{
+					const FGridIndex& gridIndex = randomGridIndexes[opNum & (NumBenchmarkInputs - 1)];
+					coordinateSum += grid.getNodeLocationOnSphereUV(gridIndex.uPos, gridIndex.vPos).X;
+				}
+				resultSink = resultSink + int64(coordinateSum);
+				return uint64(numOps) * (sizeof(FGridIndex) + sizeof(FVector3f));
+			}));
+		}
+
+		if (isSelected("getTileNeighborIndexes"))
+		{
+			//the owning copy the blueprint facing getTileNeighborIndexes hands out
+			addResult(runBenchmark("getTileNeighborIndexes", grid, options, [&](int32 numOps)
+			{
+				uint64 bytesTouched = 0;
+				for (int32 opNum = 0; opNum < numOps; ++opNum)
+				{
+					const std::vector<int32> tileNeighbors = grid.getTileNeighborView(randomTiles[opNum & (NumBenchmarkInputs - 1)]).toArray();
+					resultSink = resultSink + tileNeighbors[0];
+					bytesTouched += sizeof(int32) + tileNeighbors.size() * sizeof(int32);
+				}
+				return bytesTouched;
+			}));
+		}
+
+		if (isSelected("getTileNeighborView"))
+		{
+			addResult(runBenchmark("getTileNeighborView", grid, options, [&](int32 numOps)
+			{
+				uint64 bytesTouched = 0;
+				int64 neighborSum = 0;
+				for (int32 opNum = 0; opNum < numOps; ++opNum)
+				{
+					for (const int32& neighborIndex : grid.getTileNeighborView(randomTiles[opNum & (NumBenchmarkInputs - 1)]))
+					{
+						neighborSum += neighborIndex;
+						bytesTouched += sizeof(int32);
+					}
+					bytesTouched += sizeof(int32);
+				}
+				resultSink = resultSink + neighborSum;
+				return bytesTouched;
+			}));
+		}
+
+		const int32 benchmarkRadii[] = { 1, 2, 4, 8 };
+		for (const int32& numSteps : benchmarkRadii)
+		{
+			const std::string benchmarkName = "getTileIndexesNStepsAway/r" + std::to_string(numSteps);
+			if (!isSelected(benchmarkName))
+			{
+				continue;
+			}
+			addResult(runBenchmark(benchmarkName, grid, options, [&](int32 numOps)
+			{
+				uint64 bytesTouched = 0;
+				for (int32 opNum = 0; opNum < numOps; ++opNum)
+				{
+					const std::vector<int32> tilesInRange = grid.getTileIndexesNStepsAwayFromIndex(randomTiles[opNum & (NumBenchmarkInputs - 1)], numSteps);
+					resultSink = resultSink + int64(tilesInRange.size());
+					bytesTouched += sizeof(int32) + tilesInRange.size() * sizeof(int32);
+				}
+				return bytesTouched;
+			}));
+		}
+
+		if (isSelected("expandTileSet"))
+		{
+			//grows a set from a seed tile ring by ring, the way the plate generation grows its plates, reported per call
+			const int32 numRings = 16;
+			std::vector<bool> tileAvailability(grid.numNodes, true);
+			std::vector<int32> tileSet;
+			addResult(runBenchmark("expandTileSet", grid, options, [&](int32 numOps)
+			{
+				uint64 bytesTouched = 0;
+				for (int32 opNum = 0; opNum < numOps; ++opNum)
+				{
+					const int32 seedTile = randomTiles[opNum & (NumBenchmarkInputs - 1)];
+					tileSet.assign(1, seedTile);
+					tileAvailability[seedTile] = false;
+					for (int32 ringNum = 0; ringNum < numRings; ++ringNum)
+					{
+						const size_t startNumTiles = tileSet.size();
+						grid.expandTileSet(tileSet, tileAvailability);
+						bytesTouched += startNumTiles * sizeof(int32) + (tileSet.size() - startNumTiles) * (sizeof(int32) + 1);
+					}
+					//hand the tiles back for the next seed
+					for (const int32& tileIndex : tileSet)
+					{
+						tileAvailability[tileIndex] = true;
+					}
+				}
+				return bytesTouched;
+			}, numRings));
+		}
+	}
+
+	std::vector<int32> parseFrequencyList(const char* frequencyList)
+	{
+		std::vector<int32> gridFrequencies;
+		std::stringstream listStream(frequencyList);
+		std::string frequency;
+		while (std::getline(listStream, frequency, ','))
+		{
+			gridFrequencies.push_back(std::atoi(frequency.c_str()));
+		}
+		return gridFrequencies;
+	}
+
+	void printUsage(const char* toolName)
+	{
+		std::fprintf(stderr,
+			"usage: %s [options]\n"
+			"  --frequencies LIST   comma separated grid frequencies (default 10,100,500)\n"
+			"  --min-time MS        minimum time of one timed repetition (default 200)\n"
+			"  --seed N             seed of the random inputs (default 12345)\n"
+			"  --filter TEXT        only run the benchmarks whose name contains TEXT\n"
+			"  --output FILE        also write the results to FILE as json\n"
+			"bytes touched counts the query inputs and results, not the grid tables read along the way\n",
+			toolName);
+	}
+
+	bool parseOptions(int argc, char** argv, FBenchmarkOptions& outOptions)
+	{
+		for (int argNum = 1; argNum < argc; ++argNum)
+		{
+			const char* option = argv[argNum];
+			if (std::strcmp(option, "--help") == 0 || argNum + 1 >= argc)
+			{
+				return false;
+			}
+			const char* value = argv[++argNum];
+			if (std::strcmp(option, "--frequencies") == 0) { outOptions.gridFrequencies = parseFrequencyList(value); }
+			else if (std::strcmp(option, "--min-time") == 0) { outOptions.minRepetitionTimeMs = std::atof(value); }
+			else if (std::strcmp(option, "--seed") == 0) { outOptions.inputSeed = std::atoi(value); }
+			else if (std::strcmp(option, "--filter") == 0) { outOptions.filter = value; }
+			else if (std::strcmp(option, "--output") == 0) { outOptions.outputFile = value; }
+			else
+			{
+				return false;
+			}
+		}
+		for (const int32& gridFrequency : outOptions.gridFrequencies)
+		{
+			if (gridFrequency < 1 || gridFrequency > FIcosahedralGrid::MaxPackedGridFrequency)
+			{
+				return false;
+			}
+		}
+		return !outOptions.gridFrequencies.empty();
+	}
+
+	bool writeResults(const std::string& outputFile, const std::vector<FBenchmarkResult>& results)
+	{
+		std::ofstream outStream(outputFile.c_str());
+		if (!outStream)
+		{
+			return false;
+		}
+		outStream << "{\n\t\"benchmarks\": [\n";
+		for (size_t resultNum = 0; resultNum < results.size(); ++resultNum)
+		{
+			const FBenchmarkResult& result = results[resultNum];
+			outStream << "\t\t{ \"name\": \"" << result.benchmarkName << "\", \"gridFrequency\": " << result.gridFrequency
+				<< ", \"numTiles\": " << result.numTiles << ", \"ops\": " << result.numOps
+				<< ", \"nsPerOp\": " << result.nsPerOp << ", \"allocsPerOp\": " << result.allocsPerOp
+				<< ", \"allocatedBytesPerOp\": " << result.allocatedBytesPerOp
+				<< ", \"bytesTouchedPerOp\": " << result.bytesTouchedPerOp << " }"
+				<< (resultNum + 1 < results.size() ? ",\n" : "\n");
+		}
+		outStream << "\t]\n}\n";
+		return bool(outStream);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	FBenchmarkOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	std::printf("%-36s %6s %10s %10s %12s %10s\n", "benchmark", "freq", "ns/op", "allocs/op", "allocB/op", "bytes/op");
+	std::vector<FBenchmarkResult> results;
+	for (const int32& gridFrequency : options.gridFrequencies)
+	{
+		FIcosahedralGrid grid;
+		FSphereGridSettings gridSettings;
+		gridSettings.gridFrequency = gridFrequency;
+		gridSettings.useTopologyCache = false;
+		grid.build(gridSettings);
+		runGridBenchmarks(grid, options, results);
+	}
+
+	if (!options.outputFile.empty() && !writeResults(options.outputFile, results))
+	{
+		std::fprintf(stderr, "could not write %s\n", options.outputFile.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Generates a planet without the engine: builds the grid, the initial height map and the plates,
+// runs the plate simulation for a number of steps and writes the crust of every tile out as csv.
+// Build it with symbols (the default RelWithDebInfo) and run it under perf, valgrind or any other
+// native profiler to profile the generation
+
+#include "IcosahedralGrid.h"
+#include "TectonicSimulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+using namespace HexPlanet;
+
+namespace
+{
+	struct FGenerateOptions
+	{
+		FGenerateOptions()
+			: gridFrequency(100), numSteps(10), planetRadius(1000.0f), heightMapSeed(0), plateSeed(0), plateDirectionSeed(0),
+			numOctaves(4), foldingRatio(0.1f)
+		{
+		}
+
+		int32 gridFrequency;
+		int32 numSteps;
+		float planetRadius;
+		int32 heightMapSeed;
+		int32 plateSeed;
+		int32 plateDirectionSeed;
+		int32 numOctaves;
+		float foldingRatio;
+		std::string topologyCacheDirectory;
+		std::string outputFile;
+	};
+
+	void printUsage(const char* toolName)
+	{
+		std::fprintf(stderr,
+			"usage: %s [options]\n"
+			"  --frequency N        grid frequency (default 100)\n"
+			"  --steps N            simulation steps to run (default 10)\n"
+			"  --radius R           planet radius (default 1000)\n"
+			"  --height-seed N      seed of the initial height map (default 0)\n"
+			"  --plate-seed N       seed of the plate layout (default 0)\n"
+			"  --direction-seed N   seed of the plate directions (default 0)\n"
+			"  --octaves N          octaves of noise in the height map (default 4)\n"
+			"  --folding-ratio F    crust transfered during a collision (default 0.1)\n"
+			"  --cache-dir DIR      map the grid topology from a cache file in DIR\n"
+			"  --output FILE        write the crust of every tile to FILE as csv\n",
+			toolName);
+	}
+
+	bool parseOptions(int argc, char** argv, FGenerateOptions& outOptions)
+	{
+		for (int argNum = 1; argNum < argc; ++argNum)
+		{
+			const char* option = argv[argNum];
+			if (std::strcmp(option, "--help") == 0 || argNum + 1 >= argc)
+			{
+				return false;
+			}
+			const char* value = argv[++argNum];
+			if (std::strcmp(option, "--frequency") == 0) { outOptions.gridFrequency = std::atoi(value); }
+			else if (std::strcmp(option, "--steps") == 0) { outOptions.numSteps = std::atoi(value); }
+			else if (std::strcmp(option, "--radius") == 0) { outOptions.planetRadius = float(std::atof(value)); }
+			else if (std::strcmp(option, "--height-seed") == 0) { outOptions.heightMapSeed = std::atoi(value); }
+			else if (std::strcmp(option, "--plate-seed") == 0) { outOptions.plateSeed = std::atoi(value); }
+			else if (std::strcmp(option, "--direction-seed") == 0) { outOptions.plateDirectionSeed = std::atoi(value); }
+			else if (std::strcmp(option, "--octaves") == 0) { outOptions.numOctaves = std::atoi(value); }
+			else if (std::strcmp(option, "--folding-ratio") == 0) { outOptions.foldingRatio = float(std::atof(value)); }
+			else if (std::strcmp(option, "--cache-dir") == 0) { outOptions.topologyCacheDirectory = value; }
+			else if (std::strcmp(option, "--output") == 0) { outOptions.outputFile = value; }
+			else
+			{
+				return false;
+			}
+		}
+		return outOptions.gridFrequency >= 1 && outOptions.gridFrequency <= FIcosahedralGrid::MaxPackedGridFrequency;
+	}
+
+	/*! Reports how long each phase of the generation took*/
+	struct FPhaseTimer
+	{
+		explicit FPhaseTimer(const char* inPhaseName)
+			: phaseName(inPhaseName), startTime(std::chrono::steady_clock::now())
+		{
+		}
+		~FPhaseTimer()
+		{
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+			std::fprintf(stderr, "%-24s %10.2f ms\n", phaseName, elapsed.count());
+		}
+
+		const char* phaseName;
+		std::chrono::steady_clock::time_point startTime;
+	};
+
+	bool writeCrustCells(const std::string& outputFile, const FIcosahedralGrid& grid, const FTectonicSimulation& simulation)
+	{
+		std::ofstream outStream(outputFile.c_str());
+		if (!outStream)
+		{
+			return false;
+		}
+		outStream << "tileIndex,x,y,z,cellHeight,crustThickness,crustDensity,owningPlate\n";
+		for (int32 cellIndex = 0; cellIndex < simulation.crustCells.num(); ++cellIndex)
+		{
+			const FCrustCell crustCell = simulation.crustCells.getCell(cellIndex);
+			const FVector3f tileLocation = grid.getTileLocationOnSphere(crustCell.tileIndex);
+			outStream << crustCell.tileIndex << ',' << tileLocation.X << ',' << tileLocation.Y << ',' << tileLocation.Z << ','
+				<< crustCell.cellHeight << ',' << crustCell.crustThickness << ',' << crustCell.crustDensity << ','
+				<< crustCell.owningPlate << '\n';
+		}
+		return bool(outStream);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	FGenerateOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	FIcosahedralGrid grid;
+	{
+		FPhaseTimer timer("build grid");
+		FSphereGridSettings gridSettings;
+		gridSettings.gridFrequency = options.gridFrequency;
+		gridSettings.useTopologyCache = !options.topologyCacheDirectory.empty();
+		gridSettings.topologyCacheDirectory = options.topologyCacheDirectory;
+		grid.build(gridSettings);
+	}
+
+	FTectonicSimulation simulation;
+	simulation.settings.heightMapSeed = options.heightMapSeed;
+	simulation.settings.plateSeed = options.plateSeed;
+	simulation.settings.plateDirectionSeed = options.plateDirectionSeed;
+	simulation.settings.numOctaves = options.numOctaves;
+	simulation.settings.foldingRatio = options.foldingRatio;
+	simulation.setPlanet(&grid, options.planetRadius);
+	{
+		FPhaseTimer timer("initial height map");
+		simulation.generateInitialHeightMap();
+	}
+	{
+		FPhaseTimer timer("build plates");
+		simulation.buildTectonicPlates();
+		simulation.initializePlateDirections();
+	}
+	{
+		FPhaseTimer timer("simulation steps");
+		for (int32 stepNum = 0; stepNum < options.numSteps; ++stepNum)
+		{
+			simulation.executeTimeStep();
+		}
+	}
+	std::fprintf(stderr, "%d tiles, %d plates, %d steps\n", grid.numNodes, int32(simulation.currentPlates.size()), simulation.simulationTimeStep);
+
+	if (!options.outputFile.empty() && !writeCrustCells(options.outputFile, grid, simulation))
+	{
+		std::fprintf(stderr, "could not write %s\n", options.outputFile.c_str());
+		return 1;
+	}
+	return 0;
+}
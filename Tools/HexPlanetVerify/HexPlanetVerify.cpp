@@ -0,0 +1,221 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Checks that the grid maps the center of every tile back to that tile, at frequencies far beyond what
+// the engine components get built with. Both the mapping the grid uses for its frequency and the double
+// precision mapping from the double precision tile locations are checked. Every tile of every frequency is
+// visited, so the large frequencies need a lot of memory, building the grid peaks at roughly 75 bytes per tile,
+// 3GB at frequency 2000 and 7GB at frequency 3000. Every grid also has to report the icosahedron interior
+// angle of a freshly built grid, whether its topology was built, mapped from the cache or shared with another grid
+
+#include "IcosahedralGrid.h"
+#include "HexPlanetParallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace HexPlanet;
+
+namespace
+{
+	struct FVerifyOptions
+	{
+		FVerifyOptions()
+			: maxReportedMismatches(10)
+		{
+			gridFrequencies.push_back(1000);
+			gridFrequencies.push_back(1500);
+			gridFrequencies.push_back(2000);
+		}
+
+		std::vector<int32> gridFrequencies;
+		int32 maxReportedMismatches;
+		std::string topologyCacheDirectory;
+	};
+
+	/*! The tiles one mapping got wrong, only the first few are kept to be printed*/
+	struct FMappingMismatches
+	{
+		FMappingMismatches()
+			: numMismatches(0)
+		{
+		}
+
+		int64 numMismatches;
+		std::vector<std::pair<int32, int32>> reportedMismatches;
+		std::mutex mismatchLock;
+	};
+
+	void recordMismatches(FMappingMismatches& mismatches, const std::vector<std::pair<int32, int32>>& chunkMismatches, const int32& maxReported)
+	{
+		std::lock_guard<std::mutex> lock(mismatches.mismatchLock);
+		mismatches.numMismatches += int64(chunkMismatches.size());
+		for (const std::pair<int32, int32>& mismatch : chunkMismatches)
+		{
+			if (int32(mismatches.reportedMismatches.size()) >= maxReported)
+			{
+				break;
+			}
+			mismatches.reportedMismatches.push_back(mismatch);
+		}
+	}
+
+	bool reportMismatches(const char* mappingName, const FIcosahedralGrid& grid, FMappingMismatches& mismatches)
+	{
+		std::sort(mismatches.reportedMismatches.begin(), mismatches.reportedMismatches.end());
+		std::printf("  %-28s %12lld of %d tiles mapped elsewhere\n", mappingName, (long long)mismatches.numMismatches, grid.numNodes);
+		for (const std::pair<int32, int32>& mismatch : mismatches.reportedMismatches)
+		{
+			const FGridIndex gridIndex = grid.getPrimaryGridIndex(mismatch.first);
+			std::printf("    tile %d at (%d, %d) mapped to tile %d\n", mismatch.first, gridIndex.uPos, gridIndex.vPos, mismatch.second);
+		}
+		return mismatches.numMismatches == 0;
+	}
+
+	/*! The angle a grid that built its own topology reports, built without the cache and freed again*/
+	float getFreshInteriorAngle()
+	{
+		FIcosahedralGrid freshGrid;
+		FSphereGridSettings gridSettings;
+		gridSettings.useTopologyCache = false;
+		freshGrid.build(gridSettings);
+		return freshGrid.icosahedronInteriorAngle;
+	}
+
+	bool reportInteriorAngle(const char* gridName, const FIcosahedralGrid& grid, const float& freshInteriorAngle)
+	{
+		const bool anglePassed = grid.icosahedronInteriorAngle == freshInteriorAngle;
+		std::printf("  %-28s %12f, %s\n", gridName, grid.icosahedronInteriorAngle, anglePassed ? "same as a fresh grid" : "differs from a fresh grid");
+		return anglePassed;
+	}
+
+	bool verifyFrequency(const int32& gridFrequency, const FVerifyOptions& options, const float& freshInteriorAngle)
+	{
+		const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		FIcosahedralGrid grid;
+		FSphereGridSettings gridSettings;
+		gridSettings.gridFrequency = gridFrequency;
+		gridSettings.cacheDoublePrecisionLocations = true;
+		gridSettings.cacheDualCellGeometry = false;
+		gridSettings.cacheDiskStencils = false;
+		gridSettings.useTopologyCache = !options.topologyCacheDirectory.empty();
+		gridSettings.topologyCacheDirectory = options.topologyCacheDirectory;
+		grid.build(gridSettings);
+		const std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - startTime;
+		std::printf("frequency %d, %d tiles, %s mapping, built in %.1f s\n", gridFrequency, grid.numNodes,
+			grid.getSettings().highResolutionMapping ? "double precision" : "single precision", buildTime.count());
+
+		FMappingMismatches gridMismatches;
+		FMappingMismatches doubleMismatches;
+		const int32 TilesPerChunk = 65536;
+		const int32 numChunks = (grid.numNodes + TilesPerChunk - 1) / TilesPerChunk;
+		parallelFor(numChunks, [&](int32 chunkIndex)
+		{
+			std::vector<std::pair<int32, int32>> chunkGridMismatches;
+			std::vector<std::pair<int32, int32>> chunkDoubleMismatches;
+			const int32 chunkEnd = std::min(grid.numNodes, (chunkIndex + 1)*TilesPerChunk);
+			for (int32 tileIndex = chunkIndex*TilesPerChunk; tileIndex < chunkEnd; ++tileIndex)
+			{
+				const int32 gridTile = grid.mapPosToTileIndex(grid.getTileLocationOnSphere(tileIndex));
+				if (gridTile != tileIndex)
+				{
+					chunkGridMismatches.push_back(std::make_pair(tileIndex, gridTile));
+				}
+				FVector3d doubleLocation;
+				grid.getTileLocationOnSphereDouble(tileIndex, doubleLocation.X, doubleLocation.Y, doubleLocation.Z);
+				const int32 doubleTile = grid.mapPosToTileIndexDouble(doubleLocation);
+				if (doubleTile != tileIndex)
+				{
+					chunkDoubleMismatches.push_back(std::make_pair(tileIndex, doubleTile));
+				}
+			}
+			recordMismatches(gridMismatches, chunkGridMismatches, options.maxReportedMismatches);
+			recordMismatches(doubleMismatches, chunkDoubleMismatches, options.maxReportedMismatches);
+		});
+
+		const bool gridMappingPassed = reportMismatches("mapPosToTileIndex", grid, gridMismatches);
+		const bool doubleMappingPassed = reportMismatches("mapPosToTileIndexDouble", grid, doubleMismatches);
+		const bool anglePassed = reportInteriorAngle("interior angle", grid, freshInteriorAngle);
+		//a second grid of the frequency gets its topology from the registry instead
+		FIcosahedralGrid sharedGrid;
+		sharedGrid.build(gridSettings);
+		const bool sharedAnglePassed = reportInteriorAngle("shared interior angle", sharedGrid, freshInteriorAngle);
+		return gridMappingPassed && doubleMappingPassed && anglePassed && sharedAnglePassed;
+	}
+
+	std::vector<int32> parseFrequencyList(const char* frequencyList)
+	{
+		std::vector<int32> gridFrequencies;
+		std::stringstream listStream(frequencyList);
+		std::string frequency;
+		while (std::getline(listStream, frequency, ','))
+		{
+			gridFrequencies.push_back(std::atoi(frequency.c_str()));
+		}
+		return gridFrequencies;
+	}
+
+	void printUsage(const char* toolName)
+	{
+		std::fprintf(stderr,
+			"usage: %s [options]\n"
+			"  --frequencies LIST   comma separated grid frequencies (default 1000,1500,2000)\n"
+			"  --max-reported N     mismatching tiles printed per mapping (default 10)\n"
+			"  --cache-dir DIR      map the grid topology from a cache file in DIR\n"
+			"exits with 1 if any tile center maps to another tile or a grid reports another interior angle\n",
+			toolName);
+	}
+
+	bool parseOptions(int argc, char** argv, FVerifyOptions& outOptions)
+	{
+		for (int argNum = 1; argNum < argc; ++argNum)
+		{
+			const char* option = argv[argNum];
+			if (std::strcmp(option, "--help") == 0 || argNum + 1 >= argc)
+			{
+				return false;
+			}
+			const char* value = argv[++argNum];
+			if (std::strcmp(option, "--frequencies") == 0) { outOptions.gridFrequencies = parseFrequencyList(value); }
+			else if (std::strcmp(option, "--max-reported") == 0) { outOptions.maxReportedMismatches = std::atoi(value); }
+			else if (std::strcmp(option, "--cache-dir") == 0) { outOptions.topologyCacheDirectory = value; }
+			else
+			{
+				return false;
+			}
+		}
+		for (const int32& gridFrequency : outOptions.gridFrequencies)
+		{
+			if (gridFrequency < 1 || gridFrequency > FIcosahedralGrid::MaxPackedGridFrequency)
+			{
+				return false;
+			}
+		}
+		return !outOptions.gridFrequencies.empty();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	FVerifyOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	const float freshInteriorAngle = getFreshInteriorAngle();
+	bool allPassed = true;
+	for (const int32& gridFrequency : options.gridFrequencies)
+	{
+		allPassed = verifyFrequency(gridFrequency, options, freshInteriorAngle) && allPassed;
+		std::fflush(stdout);
+	}
+	std::printf("%s\n", allPassed ? "every grid passed" : "some grids failed");
+	return allPassed ? 0 : 1;
+}
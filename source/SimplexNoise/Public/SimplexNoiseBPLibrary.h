@@ -11,6 +11,7 @@ and modified to fit to Unreal Engine 4
 * This is a clean, fast, modern and free Perlin Simplex noise function.
 * If we change float to double it could be even faster but there is no double type in Blueprint
 * All Public Functions are BlueprintCallable so they can be used in every blueprint
+* The noise itself lives in HexPlanet::FSimplexNoiseGenerator, this library shares one generator between all blueprints
 
 
 From DevDad and Dedicated to you and Unreal Community
@@ -28,13 +29,6 @@ UCLASS()
 class SIMPLEXNOISE_API USimplexNoiseBPLibrary : public UBlueprintFunctionLibrary
 {
 	GENERATED_UCLASS_BODY()
-private:
-
-	static unsigned char perm[];
-	static float  grad(int hash, float x);
-	static float  grad(int hash, float x, float y);
-	static float  grad(int hash, float x, float y, float z);
-	static float  grad(int hash, float x, float y, float z, float t);
 
 public:
 
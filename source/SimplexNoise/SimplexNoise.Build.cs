@@ -18,7 +18,8 @@ public class SimplexNoise : ModuleRules
 			new string[] { 
 				"Core", 
 				"CoreUObject", 
-				"Engine"
+				"Engine",
+				"HexPlanetCore"
 			}
 		);
 	}